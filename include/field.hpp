@@ -0,0 +1,86 @@
+#pragma once
+#include <concepts>
+#include "types.hpp"
+#include "gf128.hpp"
+#include "gf64.hpp"
+#include "hash_prg.hpp"
+
+// ================= 域概念 =================
+// 多项式、OKVS 值与重构只依赖下面这些操作；值宽度按部署选择：
+//   GF128 —— 现行实现，Block128 值；
+//   GF64  —— 值、OKVS 存储与 S14 应答减半，乘法为单次 64x64 CLMUL。
+// 集合元素与 OKVS 键始终是 128-bit；GF64 下秘密 f_x(0) 取 x 的 64-bit 压缩。
+// lift 把秘密写回 128-bit 块（GF128 即 x 本身），标签由它导出，S31 据此校验重构出的秘密。
+
+template <class F>
+concept Field = requires(const typename F::Elem& a, const typename F::Elem& b,
+                         const Block128& x, u64 u, PRG& prg) {
+    { F::zero() }                -> std::same_as<typename F::Elem>;
+    { F::one() }                 -> std::same_as<typename F::Elem>;
+    { F::add(a, b) }             -> std::same_as<typename F::Elem>;
+    { F::mul(a, b) }             -> std::same_as<typename F::Elem>;
+    { F::inv(a) }                -> std::same_as<typename F::Elem>;
+    { F::eq(a, b) }              -> std::same_as<bool>;
+    { F::from_u64(u) }           -> std::same_as<typename F::Elem>;
+    { F::hash_to_field_u64(u) }  -> std::same_as<typename F::Elem>;
+    { F::embed(x) }              -> std::same_as<typename F::Elem>;
+    { F::lift(a) }               -> std::same_as<Block128>;
+    { F::random(prg) }           -> std::same_as<typename F::Elem>;
+    { F::bits }                  -> std::convertible_to<int>;
+};
+
+struct GF128 {
+    using Elem = Block128;
+    static constexpr int bits = 128;
+    static constexpr const char* name = "gf128";
+
+    static Elem zero()                           { return gf128::zero(); }
+    static Elem one()                            { return gf128::one(); }
+    static Elem add(const Elem& a, const Elem& b){ return gf128::add(a, b); }
+    static Elem mul(const Elem& a, const Elem& b){ return gf128::mul(a, b); }
+    static Elem inv(const Elem& a)               { return gf128::inv(a); }
+    static bool eq(const Elem& a, const Elem& b) { return a.hi == b.hi && a.lo == b.lo; }
+    static Elem from_u64(u64 x)                  { return gf128::from_u64(x); }
+    static Elem hash_to_field_u64(u64 i)         { return gf128::hash_to_field_u64(i); }
+    static Elem embed(const Block128& x)         { return x; }
+    static Block128 lift(const Elem& a)          { return a; }
+    static Elem random(PRG& prg)                 { return prg.next_block128(); }
+};
+
+struct GF64 {
+    using Elem = u64;
+    static constexpr int bits = 64;
+    static constexpr const char* name = "gf64";
+
+    static Elem zero()                 { return gf64::zero(); }
+    static Elem one()                  { return gf64::one(); }
+    static Elem add(Elem a, Elem b)    { return gf64::add(a, b); }
+    static Elem mul(Elem a, Elem b)    { return gf64::mul(a, b); }
+    static Elem inv(Elem a)            { return gf64::inv(a); }
+    static bool eq(Elem a, Elem b)     { return a == b; }
+    static Elem from_u64(u64 x)        { return gf64::from_u64(x); }
+    static Elem hash_to_field_u64(u64 i){ return gf64::hash_to_field_u64(i); }
+    static Elem embed(const Block128& x){ return x.lo ^ gf64::hash_to_field_u64(x.hi); }
+    static Block128 lift(Elem a)       { return Block128{0, a}; }
+    static Elem random(PRG& prg)       { return prg.eng(); }
+};
+
+static_assert(Field<GF128>);
+static_assert(Field<GF64>);
+
+// 域公理自检：随机元素上验证交换/结合/分配律、单位元与逆元。
+// 约简或求逆写错时这些等式几乎必然失败；S31 那边只会表现为结果集为空，难以定位
+template <Field F>
+bool field_self_check(u64 seed = 0x0F1E2D3C4B5A6978ULL, int rounds = 256) {
+    PRG prg(seed);
+    const auto one = F::one();
+    for (int r = 0; r < rounds; ++r) {
+        const auto a = F::random(prg), b = F::random(prg), c = F::random(prg);
+        if (!F::eq(F::mul(a, b), F::mul(b, a))) return false;
+        if (!F::eq(F::mul(F::mul(a, b), c), F::mul(a, F::mul(b, c)))) return false;
+        if (!F::eq(F::mul(a, F::add(b, c)), F::add(F::mul(a, b), F::mul(a, c)))) return false;
+        if (!F::eq(F::mul(a, one), a)) return false;
+        if (!F::eq(F::mul(a, F::inv(a)), one) && !F::eq(a, F::zero())) return false;
+    }
+    return true;
+}
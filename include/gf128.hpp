@@ -1,6 +1,9 @@
 #pragma once
 #include <cstdint>
 #include "types.hpp"
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
 
 // 假定 types.hpp 定义：using u64 = uint64_t; struct Block128{ u64 hi, lo; };
 
@@ -22,14 +25,21 @@ static inline Block128 sub(const Block128& a, const Block128& b){
     return add(a,b); // 同加法
 }
 
-// ====== 进位无关 64x64 乘法：可移植慢路径 ======
+// ====== 进位无关 64x64 乘法：PCLMULQDQ 快路径 / 可移植慢路径 ======
 static inline void clmul64(u64 a, u64 b, u64& hi, u64& lo){
+#if defined(__PCLMUL__)
+    __m128i r = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)a),
+                                     _mm_cvtsi64_si128((long long)b), 0x00);
+    lo = (u64)_mm_cvtsi128_si64(r);
+    hi = (u64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(r, r));
+#else
     unsigned __int128 acc = 0;
     for (int i=0;i<64;i++){
         if ((b >> i) & 1ULL) acc ^= ( (unsigned __int128)a << i );
     }
     lo = (u64)acc;
     hi = (u64)(acc >> 64);
+#endif
 }
 
 // 128x128 的 carry-less 乘法（Karatsuba 合成 256bit）
@@ -60,30 +70,15 @@ static inline void clmul128(const Block128& A, const Block128& B,
 }
 
 // ====== 模多项式约简：x^128 + x^7 + x^2 + x + 1（GHASH） ======
+// hi·x^128 ≡ hi·(x^7 + x^2 + x + 1)；左移溢出到 x^128 以上的位（hi>>121/126/127）
+// 需再折叠一次，合并进 t 后统一移位
 static inline Block128 reduce_256(const Block128& hi, const Block128& lo){
-    Block128 res = lo;
-
-    auto xor_bit = [](Block128& v, int pos){
-        if (pos < 0 || pos >= 128) return;
-        if (pos < 64) v.lo ^= (1ULL << pos);
-        else          v.hi ^= (1ULL << (pos - 64));
-    };
-
-    auto fold_word = [&](u64 word, int base){
-        while (word){
-            int t = __builtin_ctzll(word); // 取最低 1 的位置
-            int k = base + t;              // hi 的第 k 位为 1
-            xor_bit(res, k);
-            xor_bit(res, k+1);
-            xor_bit(res, k+2);
-            xor_bit(res, k+7);
-            word &= (word - 1);
-        }
-    };
-
-    fold_word(hi.lo, 0);
-    fold_word(hi.hi, 64);
-    return res;
+    using u128 = unsigned __int128;
+    const u128 H = ((u128)hi.hi << 64) | hi.lo;
+    const u128 L = ((u128)lo.hi << 64) | lo.lo;
+    const u128 t = H ^ (H >> 127) ^ (H >> 126) ^ (H >> 121);
+    const u128 r = L ^ t ^ (t << 1) ^ (t << 2) ^ (t << 7);
+    return Block128{ (u64)(r >> 64), (u64)r };
 }
 
 // 乘法：clmul128 → 约简
@@ -99,17 +94,15 @@ static inline Block128 square(const Block128& a){
     return mul(a,a);
 }
 
-// 求逆：a^(2^128 - 2)
+// 求逆：a^(2^128 - 2) = a^(2 + 4 + ... + 2^127)
 static inline Block128 inv(const Block128& a){
     if (is_zero(a)) return zero(); // 0 无逆
     Block128 result = one();
-    Block128 base   = a;
-    // 处理位 127..1 为 1，位 0 为 0
-    for (int i = 127; i >= 1; --i){
+    Block128 base   = square(a);   // 指数位 0 为 0，从 a^2 开始
+    for (int i = 1; i <= 127; ++i){
         result = mul(result, base);
         base   = square(base);
     }
-    base = square(base); // 推进最低位（0）的一次平方
     return result;
 }
 
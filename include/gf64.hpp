@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "types.hpp"
+#include "gf128.hpp"   // 复用 clmul64（PCLMULQDQ / 可移植）
+
+// GF(2^64)，模多项式 x^64 + x^4 + x^3 + x + 1；元素直接用 u64 表示
+
+namespace gf64 {
+
+static inline u64 zero() { return 0; }
+static inline u64 one()  { return 1; }
+static inline bool is_zero(u64 a){ return a == 0; }
+
+static inline u64 add(u64 a, u64 b){ return a ^ b; }
+
+// hi·x^64 ≡ hi·(x^4 + x^3 + x + 1)；溢出位（hi>>60/61/63）并入 t 再折叠
+static inline u64 reduce_128(u64 hi, u64 lo){
+    const u64 t = hi ^ (hi >> 60) ^ (hi >> 61) ^ (hi >> 63);
+    return lo ^ t ^ (t << 1) ^ (t << 3) ^ (t << 4);
+}
+
+static inline u64 mul(u64 a, u64 b){
+    u64 hi, lo;
+    gf128::clmul64(a, b, hi, lo);
+    return reduce_128(hi, lo);
+}
+
+static inline u64 square(u64 a){ return mul(a, a); }
+
+// 求逆：a^(2^64 - 2)
+static inline u64 inv(u64 a){
+    if (a == 0) return 0;
+    u64 result = 1;
+    u64 base   = square(a);
+    for (int i = 1; i <= 63; ++i){
+        result = mul(result, base);
+        base   = square(base);
+    }
+    return result;
+}
+
+static inline u64 from_u64(u64 x){ return x; }
+
+inline u64 hash_to_field_u64(u64 i){
+    u64 x = i + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace gf64
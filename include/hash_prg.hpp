@@ -2,6 +2,8 @@
 #include "types.hpp"
 #include <random>
 #include <cstring>
+#include <type_traits>
+#include <cmath>
 
 // 占位 PRG：std::mt19937_64（可重复）；建议改为 BLAKE3-XOF
 struct PRG {
@@ -23,3 +25,34 @@ inline Tag128 tag_of(const Block128& x, u64 salt){
   auto b = prg.next_block128();
   return Tag128{b.hi, b.lo};
 }
+
+// 紧凑标签：只生成所需宽度。≤64 bit 时用两轮 64-bit 混合（覆盖 x 的全部 128 位），
+// 不再为每个元素构造 mt19937_64；128 bit 沿用 tag_of 保持与旧结果一致
+template <class T>
+inline T tag_of_bits(const Block128& x, u64 salt, int bits){
+  if constexpr (std::is_same_v<T, Tag128>) {
+    (void)bits;
+    return tag_of(x, salt);
+  } else {
+    auto fmix = [](u64 z){
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    };
+    u64 z = fmix(fmix(x.hi ^ salt) ^ x.lo);
+    if (bits < 64) z &= (1ULL << bits) - 1;
+    return (T)z;
+  }
+}
+
+// 标签误匹配上界：S31 中同一桶内两个不同元素标签相同，会把两组份额并成一组。
+// 混入的点过不了多余点一致与秘密重算标签两项校验，只会让真实交集元素校验失败而漏报，不会误报。
+// 每桶至多 L ≈ n·Σ|X_i|/B 个不同元素（每个元素放 n 份到 n 个桶），对所有桶做联合界：
+//   P[任一误匹配] ≤ B · C(L,2) · 2^-b ≈ (n·Σ|X_i|)² / (2B) · 2^-b
+// 返回 log2 上界（>0 表示几乎必然发生）。例：n=50、|X_i|=4096、B≈5325 时
+// 32 bit ≈ 2^1.2，64 bit ≈ 2^-30.8，128 bit ≈ 2^-94.8
+inline double tag_false_match_log2(int bits, int n, size_t total_elems, size_t B){
+  const double L = (double)n * (double)total_elems / (double)B;
+  const double pairs = (double)B * L * (L - 1.0) / 2.0;
+  return (pairs > 0 ? std::log2(pairs) : -1e9) - (double)bits;
+}
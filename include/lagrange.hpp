@@ -2,42 +2,84 @@
 #include <vector>
 #include "types.hpp"
 #include "gf128.hpp"
+#include "field.hpp"
 
-namespace gf128 {
-
-// 拉格朗日插值：在 GF(2^128) 上，用 k 个点 (x_i, y_i) 计算 f(x0)
-static inline Block128 lagrange_at_gf128(
-    const std::vector<std::pair<Block128, Block128>>& pts,
-    const Block128& x0)
+// 拉格朗日插值：在域 F 上，用 k 个点 (x_i, y_i) 计算 f(x0)
+template <Field F>
+static inline typename F::Elem lagrange_at(
+    const std::vector<std::pair<typename F::Elem, typename F::Elem>>& pts,
+    const typename F::Elem& x0)
 {
-    using namespace gf128;
-    Block128 acc = zero();
+    using E = typename F::Elem;
+    E acc = F::zero();
 
     for (size_t i = 0; i < pts.size(); ++i){
-        const Block128 xi = pts[i].first;
-        const Block128 yi = pts[i].second;
+        const E xi = pts[i].first;
+        const E yi = pts[i].second;
 
         // 计算 L_i(x0) = Π_{j≠i} (x0 - x_j)/(x_i - x_j)
         // 在 GF(2^m) 中 - == +，因此 (x0 - xj) == (x0 ^ xj)
-        Block128 num = one();
-        Block128 den = one();
+        E num = F::one();
+        E den = F::one();
         for (size_t j = 0; j < pts.size(); ++j){
             if (j == i) continue;
-            const Block128 xj = pts[j].first;
-            Block128 t_num = add(x0, xj);
-            Block128 t_den = add(xi, xj);
-            num = mul(num, t_num);
-            den = mul(den, t_den);
+            const E xj = pts[j].first;
+            num = F::mul(num, F::add(x0, xj));
+            den = F::mul(den, F::add(xi, xj));
         }
-        Block128 Li = mul(num, inv(den));
-        acc = add(acc, mul(yi, Li));
+        E Li = F::mul(num, F::inv(den));
+        acc = F::add(acc, F::mul(yi, Li));
     }
     return acc; // f(x0)
 }
 
-// 便捷：把 u64 作为横坐标（参与方编号）→ GF(2^128)
+// 同一组点要在多处求值时（S31 校验多余点）：先求 w_i = y_i / Π_{j≠i}(x_i - x_j)，
+// 之后每个求值点 f(x0) = Σ w_i Π_{j≠i}(x0 - x_j) 只需乘法，不再求逆
+template <Field F>
+static inline void lagrange_weights(
+    const std::vector<std::pair<typename F::Elem, typename F::Elem>>& pts,
+    std::vector<typename F::Elem>& w)
+{
+    using E = typename F::Elem;
+    w.resize(pts.size());
+    for (size_t i = 0; i < pts.size(); ++i){
+        E den = F::one();
+        for (size_t j = 0; j < pts.size(); ++j)
+            if (j != i) den = F::mul(den, F::add(pts[i].first, pts[j].first));
+        w[i] = F::mul(pts[i].second, F::inv(den));
+    }
+}
+
+template <Field F>
+static inline typename F::Elem lagrange_eval(
+    const std::vector<std::pair<typename F::Elem, typename F::Elem>>& pts,
+    const std::vector<typename F::Elem>& w,
+    const typename F::Elem& x0)
+{
+    using E = typename F::Elem;
+    E acc = F::zero();
+    for (size_t i = 0; i < pts.size(); ++i){
+        E num = w[i];
+        for (size_t j = 0; j < pts.size(); ++j)
+            if (j != i) num = F::mul(num, F::add(x0, pts[j].first));
+        acc = F::add(acc, num);
+    }
+    return acc;
+}
+
+namespace gf128 {
+
+// 拉格朗日插值：在 GF(2^128) 上，用 k 个点 (x_i, y_i) 计算 f(x0)
+static inline Block128 lagrange_at_gf128(
+    const std::vector<std::pair<Block128, Block128>>& pts,
+    const Block128& x0)
+{
+    return lagrange_at<GF128>(pts, x0);
+}
+
+// 便捷：参与方编号 → 横坐标 α（与 S12 求值一致，走 hash_to_field_u64）
 static inline Block128 x_from_party_id_u64(u64 party_id){
-    return from_u64(party_id);
+    return hash_to_field_u64(party_id);
 }
 
 } // namespace gf128
@@ -1,6 +1,7 @@
 #pragma once
 #include "types.hpp"
 #include <algorithm>
+#include <cstdint>
 
 inline u64 h_pos(const Block128& x, u64 dom, u64 seed, u64 B){
   // 简化位置哈希（真实请用 BLAKE3 域分离）
@@ -9,26 +10,105 @@ inline u64 h_pos(const Block128& x, u64 dom, u64 seed, u64 B){
   return h % B;
 }
 
-inline std::vector<size_t> positions_sorted_n(const Block128& x, int n, u64 seed_pos, size_t B){
-  std::vector<size_t> I; I.reserve(n);
+// 写入调用方提供的 I（复用其容量，逐元素放置时不再分配）
+inline void positions_sorted_n(const Block128& x, int n, u64 seed_pos, size_t B, std::vector<size_t>& I){
+  I.clear();
   for(int ell=1; ell<=n; ++ell) I.push_back(h_pos(x, ell, seed_pos, B));
   std::sort(I.begin(), I.end());
+}
+
+inline std::vector<size_t> positions_sorted_n(const Block128& x, int n, u64 seed_pos, size_t B){
+  std::vector<size_t> I; I.reserve(n);
+  positions_sorted_n(x, n, seed_pos, B, I);
   return I;
 }
 
-// 插入规则（与你的 S23 对齐）
+// 插入规则：第 i 方把“来自 g 的份额”放在 I[(g - i) mod n]，自己的份额总在 I[0]。
+// 各持有方的自有份额因此同落在桶 I[0]，S31 在那里凑齐全部持有方的点；
+// 其他位置混有非持有方的随机 σ，过不了重构校验。
+// 位置哈希碰撞（I 有序，重复值相邻）时只保留下标较小者：重复下标上的份额各方都不放，
+// 否则同一方的两个份额进同一桶，会凑出不同标号的假点
+inline size_t slot_of(int g, int i, int n){ return (size_t)((g - i + n) % n); }
+inline bool slot_dup(const std::vector<size_t>& I, size_t q){ return q > 0 && I[q] == I[q-1]; }
+
+template <class V, class T>
 inline void insert_element_Ti(
-  HashTableTi& Ti, size_t B, int n, int i,
-  const Block128& x, const Tag128& tag_x,
-  const Block128& fxi,
-  const std::vector<std::pair<int, Block128>>& sigmas_gamma,
-  u64 seed_pos
+  HashTableTiT<V, T>& Ti, size_t B, int n, int i,
+  const Block128& x, const T& tag_x,
+  const V& fxi,
+  const std::vector<std::pair<int, V>>& sigmas_gamma,
+  u64 seed_pos,
+  std::vector<size_t>& I   // 位置暂存
 ){
-  auto I = positions_sorted_n(x, n, seed_pos, B);
-  size_t idx_self = I[( (i + i - 1) % n )];
-  Ti.table[idx_self].items.push_back( Share{i, fxi, tag_x} );
+  positions_sorted_n(x, n, seed_pos, B, I);
+  Ti.table[I[0]].items.push_back( ShareT<V, T>{i, tag_x, fxi} );
   for(auto& [g, sig] : sigmas_gamma){
-    size_t idx_g = I[( (g + i - 1) % n )];
-    Ti.table[idx_g].items.push_back( Share{g, sig, tag_x} );
+    const size_t q = slot_of(g, i, n);
+    if (slot_dup(I, q)) continue;
+    Ti.table[I[q]].items.push_back( ShareT<V, T>{g, tag_x, sig} );
   }
 }
+
+template <class V, class T>
+inline void insert_element_Ti(
+  HashTableTiT<V, T>& Ti, size_t B, int n, int i,
+  const Block128& x, const T& tag_x,
+  const V& fxi,
+  const std::vector<std::pair<int, V>>& sigmas_gamma,
+  u64 seed_pos
+){
+  std::vector<size_t> I;
+  insert_element_Ti(Ti, B, n, i, x, tag_x, fxi, sigmas_gamma, seed_pos, I);
+}
+
+// 流式版本：只放置落在桶区间 [lo, hi) 的份额（Tc.table 大小为 hi-lo，下标相对 lo）。
+// σ 通过 sigma_of(g) 按需取得，且只对落在区间内的 g 调用，整体 Decode 次数与全量版本相同
+template <class V, class T, class SigmaFn>
+inline void insert_element_Ti_range(
+  HashTableTiT<V, T>& Tc, size_t lo, size_t hi, size_t B, int n, int i,
+  const Block128& x, const T& tag_x,
+  const V& fxi,
+  SigmaFn&& sigma_of,
+  u64 seed_pos,
+  std::vector<size_t>& I   // 位置暂存
+){
+  positions_sorted_n(x, n, seed_pos, B, I);
+  if (I.back() < lo || I.front() >= hi) return;
+  if (I[0] >= lo && I[0] < hi)
+    Tc.table[I[0] - lo].items.push_back( ShareT<V, T>{i, tag_x, fxi} );
+  for(int g=1; g<=n; ++g){
+    if (g == i) continue;
+    const size_t q = slot_of(g, i, n);
+    if (I[q] < lo || I[q] >= hi || slot_dup(I, q)) continue;
+    Tc.table[I[q] - lo].items.push_back( ShareT<V, T>{g, tag_x, sigma_of(g)} );
+  }
+}
+
+// 流式放置的分块索引（CSR）：块 c 的元素下标为 idx[off[c] .. off[c+1])，元素的任一位置落在块内即列入。
+// 每方每次运行建一次（位置哈希 2 遍），各块只遍历涉及本块的元素，
+// 而不是每块都对全部元素重算 n 个位置（块数 × n·|X_i| 次哈希与排序）
+struct ChunkIndex {
+  std::vector<size_t>   off;   // 块数 + 1 项
+  std::vector<uint32_t> idx;   // 每元素至多 min(n, 块数) 项
+};
+
+template <class V>
+inline void build_chunk_index(ChunkIndex& ci, const std::vector<KVT<V>>& kv, int n, u64 seed_pos,
+                              size_t B, size_t chunk_buckets,
+                              std::vector<size_t>& I   // 位置暂存
+){
+  const size_t nchunks = (B + chunk_buckets - 1) / chunk_buckets;
+  // I 有序，同块的位置相邻：对每个不同的块调用一次 f
+  auto each_chunk = [&](const Block128& x, auto&& f){
+    positions_sorted_n(x, n, seed_pos, B, I);
+    for(size_t q=0; q<I.size(); ++q)
+      if (q == 0 || I[q] / chunk_buckets != I[q-1] / chunk_buckets) f(I[q] / chunk_buckets);
+  };
+  // 计数放在 off[c+2]，前缀和后 off[c+1] 为块 c 的起点；填充时把它推进到终点，最后去掉多出的一项
+  ci.off.assign(nchunks + 2, 0);
+  for(size_t j=0; j<kv.size(); ++j) each_chunk(kv[j].key, [&](size_t c){ ++ci.off[c+2]; });
+  for(size_t c=2; c<ci.off.size(); ++c) ci.off[c] += ci.off[c-1];
+  ci.idx.resize(ci.off.back());
+  for(size_t j=0; j<kv.size(); ++j) each_chunk(kv[j].key, [&](size_t c){ ci.idx[ci.off[c+1]++] = (uint32_t)j; });
+  ci.off.pop_back();
+}
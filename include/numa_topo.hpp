@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ================= NUMA 拓扑与内存放置 =================
+// 拓扑读自 /sys/devices/system/node；读不到（非 Linux、容器屏蔽）则视为单节点。
+// 内存放置直接走 mbind 系统调用，不依赖 libnuma；单节点时调用方直接跳过放置。
+// 放置失败只影响性能，不影响正确性（均返回 bool，不抛异常）。
+
+namespace numa {
+
+// 下标 0..nodes()-1 是紧凑序号（线程池、副本按它排列）；交给内核（mbind）时必须换成 ids[] 里的真实编号
+struct Topology {
+  std::vector<std::vector<int>> cpus;   // cpus[nd] = 第 nd 个节点的 CPU 编号
+  std::vector<int> ids;                 // ids[nd] = 第 nd 个节点的真实编号（/sys/.../node<id>）
+
+  int nodes() const { return (int)cpus.size(); }
+  bool multi() const { return cpus.size() > 1; }
+};
+
+Topology detect();
+
+// 解析 "0-3,8,10-11" 形式的 cpulist
+std::vector<int> parse_cpulist(const std::string& s);
+
+// 把调用线程绑定到给定 CPU 集合
+bool pin_current_thread(const std::vector<int>& cpus);
+
+// 把 [p, p+len) 内完整覆盖的页绑定到 node；move=true 时迁移已分配的页。
+// 策略会留在该地址区间上：只用于本进程独占的映射（NodeBuffer），不要用于 malloc 得到的内存
+bool bind(const void* p, size_t len, int node, bool move);
+
+// 调用线程当前所在的节点（getcpu）；失败返回 -1
+int current_node();
+
+// 给定地址所在页实际驻留的节点（move_pages 查询，不迁移）：返回多数页所在节点；
+// 页均未分配或查询失败时返回 -1。最多查询 64 个地址
+int pages_node(const void* const* addrs, size_t count);
+
+// [p, p+len) 的驻留节点：均匀抽取至多 32 页交给 pages_node
+int region_node(const void* p, size_t len);
+
+// 页类型：Normal 普通页；THP 透明大页（madvise）；HugeTLB 显式大页（MAP_HUGETLB，不可用时回退普通页）
+enum class Pages { Normal, THP, HugeTLB };
+
+// 节点本地缓冲：mmap 后先 mbind 再首次写入，保证页落在目标节点。仅可移动
+class NodeBuffer {
+public:
+  NodeBuffer() = default;
+  ~NodeBuffer();
+  NodeBuffer(NodeBuffer&& o) noexcept;
+  NodeBuffer& operator=(NodeBuffer&& o) noexcept;
+  NodeBuffer(const NodeBuffer&) = delete;
+  NodeBuffer& operator=(const NodeBuffer&) = delete;
+
+  // 容量不足或节点变化时重新映射；node 为真实节点编号（Topology::ids）。成功返回 true
+  bool ensure(size_t bytes, int node, Pages pages);
+
+  void* data() const { return base_; }
+  size_t capacity() const { return len_; }
+  bool bound() const { return bound_; }   // mbind 是否成功（失败时页按默认策略分配）
+  template <class E> E* as() const { return static_cast<E*>(base_); }
+
+private:
+  void release();
+  void*  base_{nullptr};
+  size_t len_{0};
+  int    node_{-1};
+  bool   bound_{false};
+};
+
+} // namespace numa
@@ -2,13 +2,30 @@
 #include "types.hpp"
 #include "gf128.hpp"
 #include "hash_prg.hpp"
+#include "field.hpp"
+
+// f_x(t) = s ⊕ r1 t ⊕ ... ⊕ r_{k-1} t^{k-1}，Horner 计算 f_x(α_i)；系数由 prg_for_x 按序抽取。
+// r 为调用方持有的系数暂存（逐元素调用时复用容量）
+template <Field F>
+inline typename F::Elem poly_eval_at(const typename F::Elem& secret, const typename F::Elem& alpha_i,
+                                     int k, PRG& prg_for_x, std::vector<typename F::Elem>& r){
+  using E = typename F::Elem;
+  if(k<=1) return secret;
+  r.resize(k-1);
+  for(int d=0; d<k-1; ++d) r[d] = F::random(prg_for_x);
+  E acc = r.back();
+  for(int d=k-3; d>=0; --d) acc = F::add(F::mul(acc, alpha_i), r[d]);
+  return F::add(F::mul(acc, alpha_i), secret);
+}
+
+template <Field F>
+inline typename F::Elem poly_eval_at(const typename F::Elem& secret, const typename F::Elem& alpha_i,
+                                     int k, PRG& prg_for_x){
+  std::vector<typename F::Elem> r;
+  return poly_eval_at<F>(secret, alpha_i, k, prg_for_x, r);
+}
 
 // f_x(t) = x ⊕ r1 t ⊕ ... ⊕ r_{k-1} t^{k-1}，Horner 计算 f_x(i)
 inline Block128 poly_eval_fx_at_i(const Block128& x, const Block128& alpha_i, int k, PRG& prg_for_x){
-  if(k<=1) return x;
-  std::vector<Block128> r(k-1);
-  for(int d=0; d<k-1; ++d) r[d] = prg_for_x.next_block128();
-  Block128 acc = r.back();
-  for(int d=k-3; d>=0; --d) acc = gf_add(gf_mul(acc, alpha_i), r[d]);
-  return gf_add(gf_mul(acc, alpha_i), x);
+  return poly_eval_at<GF128>(x, alpha_i, k, prg_for_x);
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "types.hpp"   // 已经有 OKVSParams、Block128、KV
+#include <algorithm>
 #include <vector>
 #include <cstdint>
 #include <cstring>
@@ -10,21 +11,40 @@ extern "C" {
 }
 
 // ================= RB-OKVS 存储结构 =================
-struct RBOKVS {
+// V 为值类型（域元素）：Block128 → GF(2^128)，u64 → GF(2^64)；键恒为 Block128
+template <class V>
+struct RBOKVST {
     OKVSParams p;
-    std::vector<Block128> S;  // 长度 m 的存储向量
+    std::vector<V> S;  // 长度 m 的存储向量
 
 // *** COMM *** 新增：计算 OKVS 的字节大小（用于通信量统计）
     size_t byte_size() const {
-        return S.size() * sizeof(Block128);
+        return S.size() * sizeof(V);
     }
 
+    // 消元行：u 指向 Scratch::bits 中本行的 w 字节（每字节一位），lead 为首个 1 所在列
+    struct Row { size_t a; size_t lead; uint8_t* u; V v; };
+    // 编码暂存：行、行位图与主元表都由调用方持有，重复编码同规模的表时不再分配
+    struct Scratch {
+        std::vector<Row>     rows;
+        std::vector<uint8_t> bits;       // |kvs|·w
+        std::vector<size_t>  pivot_at;   // 列 → 主元行下标（无主元为 SIZE_MAX）
+    };
+
     // 编码：把若干 (key, value) 映射到 S
-    static RBOKVS Encode(const std::vector<KV>& kvs, const OKVSParams& p);
+    static RBOKVST Encode(const std::vector<KVT<V>>& kvs, const OKVSParams& p);
+    // 编码到已有的 out（复用 out.S 的容量），暂存取自 sc
+    static void EncodeInto(RBOKVST& out, const std::vector<KVT<V>>& kvs, const OKVSParams& p, Scratch& sc);
     // 解码：从 key 恢复 value
-    Block128 Decode(const Block128& key) const;
+    V Decode(const Block128& key) const { return DecodeAt(p, S.data(), key); }
+    // 直接在外部存储上解码（如映射到共享内存的表），S 长度须为 p.m
+    static V DecodeAt(const OKVSParams& p, const V* S, const Block128& key);
 };
 
+// 实例化见 rbokvs.cpp
+using RBOKVS   = RBOKVST<Block128>;
+using RBOKVS64 = RBOKVST<u64>;
+
 // ------------- 工具：Block128 序列化（大端） -------------
 inline void ser_block128_be(const Block128& k, uint8_t out[16]) {
     auto wr64be = [](uint64_t x, uint8_t* b){
@@ -75,33 +95,40 @@ inline size_t H1(const Block128& k, const OKVSParams& p) {
     return (size_t)(x % range);
 }
 
-// H2：把 key 映射为长度为 w 的 {0,1} 向量（任意 w，XOF 流按位取）
-inline std::vector<uint8_t> H2(const Block128& k, const OKVSParams& p) {
-    const uint32_t w = p.w;
-    std::vector<uint8_t> bits(w);
-
+// H2 的 XOF：以 seed_r2 为密钥对 key 做 keyed BLAKE3，第 j 位取输出第 j>>3 字节的 (j&7) 位
+inline void H2_hasher(const Block128& k, const OKVSParams& p, blake3_hasher& hasher) {
     uint8_t key32[32]; fill_key_from_seed(p.seed_r2, key32);
     uint8_t in[16];    ser_block128_be(k, in);
-
-    blake3_hasher hasher;
     blake3_hasher_init_keyed(&hasher, key32);
     blake3_hasher_update(&hasher, in, 16);
+}
 
-    const size_t nbytes = (w + 7) / 8;
-    std::vector<uint8_t> stream(nbytes, 0);
-    blake3_hasher_finalize_seek(&hasher, 0, stream.data(), stream.size());
-
-    // 展开到位（第 j 位取 stream[j>>3] 的 (j&7) 位）
-    for (uint32_t j = 0; j < w; ++j) {
-        bits[j] = (stream[j >> 3] >> (j & 7)) & 1;
+// 按 64 字节一段读 XOF 流，对每个为 1 的位 j 调用 on_bit(j)；返回是否出现过 1。
+// 流放在栈上，编码与解码都不为位向量分配内存
+template <class OnBit>
+inline bool H2_for_each_bit(const Block128& k, const OKVSParams& p, OnBit&& on_bit) {
+    blake3_hasher hasher;
+    H2_hasher(k, p, hasher);
+    uint8_t buf[64];
+    bool any = false;
+    for (size_t j0 = 0; j0 < p.w; j0 += 8 * sizeof(buf)) {
+        const size_t nbits = std::min<size_t>(8 * sizeof(buf), p.w - j0);
+        blake3_hasher_finalize_seek(&hasher, j0 / 8, buf, (nbits + 7) / 8);
+        for (size_t j = 0; j < nbits; ++j)
+            if ((buf[j >> 3] >> (j & 7)) & 1) { on_bit(j0 + j); any = true; }
     }
+    return any;
+}
 
+// H2：把 key 映射为长度为 w 的 {0,1} 向量，写入调用方提供的 bits[0..w)
+inline void H2(const Block128& k, const OKVSParams& p, uint8_t* bits) {
+    std::memset(bits, 0, p.w);
     // 极小概率全 0（≈2^-w），做兜底以避免退化行
-    if (w > 0) {
-        bool all_zero = true;
-        for (auto b : bits) { if (b) { all_zero = false; break; } }
-        if (all_zero) bits[0] = 1;
-    }
-    return bits;
+    if (!H2_for_each_bit(k, p, [&](size_t j){ bits[j] = 1; }) && p.w > 0) bits[0] = 1;
 }
 
+inline std::vector<uint8_t> H2(const Block128& k, const OKVSParams& p) {
+    std::vector<uint8_t> bits(p.w);
+    H2(k, p, bits.data());
+    return bits;
+}
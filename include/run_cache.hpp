@@ -0,0 +1,85 @@
+#pragma once
+#include "types.hpp"
+#include "rbokvs.hpp"
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ================= S12/S13 产物缓存（内容寻址） =================
+// 相同输入（集合、OKVS 参数、盐、k）重复运行时，S12 份额/标签与 S13 编码结果完全确定，
+// 可直接复用并跳到 S14。键为 BLAKE3(输入) 摘要；内存层按字节数 LRU 淘汰，可选磁盘层。
+
+using RunDigest = std::array<uint8_t, 32>;
+
+// 单次运行 S12/S13 的全部产物（下标 1..n，与 run_once 一致）；V 为域元素类型，T 为标签类型
+template <class V, class T = Tag128>
+struct EncodedPartiesT {
+  std::vector<std::vector<KVT<V>>> kv_all;
+  std::vector<std::vector<T>>      tag_all;
+  std::vector<RBOKVST<V>>          okvs;
+
+  size_t byte_size() const;
+};
+using EncodedParties = EncodedPartiesT<Block128>;
+
+// 计算缓存键：域分离串 + 域宽度 + 标签宽度 + k + 盐 + 每方 (OKVSParams, |X_i|, X_i)
+RunDigest run_digest(const std::vector<std::vector<Block128>>& Xs,
+                     const std::vector<OKVSParams>& params,
+                     int k, u64 poly_salt, u64 salt_tag, int field_bits, int tag_bits);
+
+std::string digest_hex(const RunDigest& d);
+
+// 实例化见 run_cache.cpp（值 Block128 / u64 × 标签 u32 / u64 / Tag128）
+template <class V, class T = Tag128>
+class RunCacheT {
+public:
+  using EncodedParties = EncodedPartiesT<V, T>;
+
+  // max_bytes：内存层上限（0 表示不保留内存层）；disk_dir 为空则不落盘
+  explicit RunCacheT(size_t max_bytes, std::string disk_dir = "");
+
+  // 命中返回共享只读产物；未命中返回 nullptr。磁盘命中会回填内存层。
+  // sizes[i] 为第 i 方的 |X_i|（含下标 0 的空位，即 Xs.size() 项），用于校验磁盘文件
+  std::shared_ptr<const EncodedParties> get(const RunDigest& key, const std::vector<size_t>& sizes);
+  void put(const RunDigest& key, std::shared_ptr<const EncodedParties> val);
+
+  struct Stats { uint64_t hits{0}, disk_hits{0}, misses{0}, evictions{0}; size_t bytes{0}; };
+  Stats stats() const;
+
+private:
+  struct Entry {
+    RunDigest key;
+    std::shared_ptr<const EncodedParties> val;
+    size_t bytes;
+  };
+  struct DigestHash {
+    size_t operator()(const RunDigest& d) const {
+      size_t h; std::memcpy(&h, d.data(), sizeof(h)); return h;
+    }
+  };
+
+  void insert_locked(const RunDigest& key, std::shared_ptr<const EncodedParties> val);
+  std::string path_of(const RunDigest& key) const;
+
+  size_t max_bytes_;
+  std::string disk_dir_;
+  std::list<Entry> lru_;   // 头部 = 最近使用
+  std::unordered_map<RunDigest, typename std::list<Entry>::iterator, DigestHash> index_;
+  mutable std::mutex mu_;
+  Stats st_;
+};
+
+using RunCache = RunCacheT<Block128>;
+
+// 磁盘层序列化（失败返回 false / nullptr，不抛异常）；文件头记录值/标签宽度，不匹配即视为未命中。
+// 正文带 BLAKE3 校验和；读取时方数须等于 sizes.size()，每方 kv 与标签长度须等于 sizes[i]，
+// 各向量长度不得超过文件剩余字节：损坏、截断或与输入不符的文件按未命中处理
+template <class V, class T>
+bool save_encoded(const std::string& path, const RunDigest& key, const EncodedPartiesT<V, T>& e);
+template <class V, class T>
+std::shared_ptr<EncodedPartiesT<V, T>> load_encoded(const std::string& path, const RunDigest& key,
+                                                    const std::vector<size_t>& sizes);
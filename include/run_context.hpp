@@ -0,0 +1,110 @@
+#pragma once
+#include "types.hpp"
+#include "layout.hpp"
+#include "run_cache.hpp"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// ================= 跨重复运行复用的缓冲区 =================
+// run_once 的各阶段都从这里取容器，而不是每次重新分配：
+// 形状 (n, B, 块桶数, 组数) 不变时 reset 只 clear()，容量单调增长并保留到下一次；
+// 形状变化时整体重建，避免上一组参数的峰值容量一直驻留。
+
+// 一组 n+1 张份额表，以及每方放置时的位置暂存（同一组内各方可并行）
+template <class V, class T = Tag128>
+struct TableSetT {
+  std::vector<HashTableTiT<V, T>>  Ts;
+  std::vector<std::vector<size_t>> pos;
+};
+
+// S31 单个桶区间的暂存：合并后的份额、插值点（前 k 个 / 多余的）、插值权重、通过校验的标签
+template <class V, class T = Tag128>
+struct S31ScratchT {
+  std::vector<ShareT<V, T>>      pool;
+  std::vector<std::pair<V, V>>   pts;
+  std::vector<std::pair<V, V>>   extra;
+  std::vector<V>                 w;
+  std::vector<u64>               out;
+};
+
+template <class V, class T = Tag128>
+class RunContextT {
+public:
+  using Tables  = TableSetT<V, T>;
+  using Scratch = S31ScratchT<V, T>;
+
+  // 每次运行开始时调用。groups 组份额表、每组 buckets 个桶（全量为 B，流式为块桶数）；
+  // s31_slots 为可能并发的 S31 区间数。defer_tables=true 时重建后的份额表不分配桶数组，
+  // 由各方放置前自行 ensure_table（多节点 DAG：在绑核的 Place[i] 里首次触碰，桶头落在本方节点）
+  void reset(int n, size_t buckets, size_t groups, size_t s31_slots, bool defer_tables = false) {
+    if (n != n_ || buckets != buckets_ || groups != tables.size() || defer_tables != defer_) {
+      tables.assign(groups, Tables{});
+      for (auto& ts : tables) {
+        ts.Ts.assign(n+1, HashTableTiT<V, T>{});
+        if (!defer_tables) for (auto& t : ts.Ts) t.table.resize(buckets);
+        ts.pos.assign(n+1, {});
+      }
+      sig.assign(n+1, {});
+      sigmas.assign(n+1, {});
+      n_ = n; buckets_ = buckets; defer_ = defer_tables;
+    } else {
+      for (auto& ts : tables) clear_tables(ts.Ts);
+    }
+
+    if (enc_scratch.size() != (size_t)n + 1) enc_scratch.resize(n+1);
+    if (chunk_idx.size() != (size_t)n + 1) chunk_idx.resize(n+1);
+    if (s31.size() != s31_slots) s31.resize(s31_slots);
+    for (auto& sc : s31) sc.out.clear();
+    result.clear();
+  }
+
+  // 第 i 方放置前调用：桶数组未建（defer_tables）则按当前桶数建立；各方只碰自己的表，可并行
+  void ensure_table(HashTableTiT<V, T>& t) const {
+    if (t.table.size() != buckets_) t.table.resize(buckets_);
+  }
+
+  // S12/S13 产物容器：上次的产物若仍被缓存持有则另起一份，否则清空复用（保留各方向量容量）
+  std::shared_ptr<EncodedPartiesT<V, T>> take_encoded(int n) {
+    if (!enc_ || enc_.use_count() > 1) enc_ = std::make_shared<EncodedPartiesT<V, T>>();
+    enc_->kv_all.resize(n+1);
+    enc_->tag_all.resize(n+1);
+    enc_->okvs.resize(n+1);
+    for (auto& v : enc_->kv_all)  v.clear();
+    for (auto& v : enc_->tag_all) v.clear();
+    return enc_;
+  }
+
+  // DAG 全量模式的 σ 暂存（每方 |X_i|·(n+1) 个值，内容由 S14 节点整体覆盖）
+  void prepare_sig(const std::vector<size_t>& ni) {
+    const size_t n = ni.size() - 1;
+    for (size_t i=1; i<=n; ++i) sig[i].resize(ni[i] * (n+1));
+  }
+
+  // 合并各区间输出为去重后的结果集
+  void collect_result() {
+    for (auto& sc : s31) result.insert(result.end(), sc.out.begin(), sc.out.end());
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+
+  static void clear_tables(std::vector<HashTableTiT<V, T>>& Ts) {
+    for (auto& tbl : Ts)
+      for (auto& b : tbl.table) b.items.clear();
+  }
+
+  std::vector<Tables>              tables;   // 全量：1 组；流式：在途块数组
+  std::vector<std::vector<V>>      sig;      // DAG 全量：sig[i][j*(n+1)+g] = okvs[g].Decode(x_j)
+  std::vector<std::vector<std::pair<int, V>>> sigmas;   // sigmas[i]：第 i 方当前元素的 (g, σ)，各方独立
+  std::vector<typename RBOKVST<V>::Scratch> enc_scratch;   // S13：每方一份编码暂存（各方可并行）
+  std::vector<ChunkIndex>          chunk_idx;   // 流式：chunk_idx[i] 为第 i 方的分块索引（每次运行重建）
+  std::vector<Scratch>             s31;      // 每个 S31 区间一份
+  std::vector<u64>                 result;   // 通过校验的标签（collect_result 后有序去重）
+
+private:
+  int    n_{-1};
+  size_t buckets_{0};
+  bool   defer_{false};
+  std::shared_ptr<EncodedPartiesT<V, T>> enc_;
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ================= 依赖驱动的协程调度器 =================
+// 每个节点是一个分离式协程：依次 co_await 其依赖节点的完成事件，再切到线程池执行。
+// 节点按加入顺序天然为拓扑序（依赖只能引用已存在节点），便于事后求关键路径。
+// 同一 Graph 可反复 run：节点名、函数与协程帧存储都保留，重复运行不再分配。
+
+namespace sched {
+
+// ------------- 线程池：只负责恢复协程句柄 -------------
+class Pool {
+public:
+  explicit Pool(unsigned threads = 0);   // 0 → hardware_concurrency
+  // on_start(t) 在第 t 个工作线程开始取任务前调用（如绑定 CPU）
+  Pool(unsigned threads, std::function<void(unsigned)> on_start);
+  ~Pool();
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  void post(std::coroutine_handle<> h);
+  unsigned size() const { return (unsigned)threads_.size(); }
+
+  // co_await pool.schedule()：把当前协程挪到池中线程继续执行
+  auto schedule() {
+    struct Awaiter {
+      Pool* p;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> h) { p->post(h); }
+      void await_resume() const noexcept {}
+    };
+    return Awaiter{this};
+  }
+
+private:
+  void worker(unsigned t);
+
+  std::vector<std::thread> threads_;
+  std::deque<std::coroutine_handle<>> q_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::function<void(unsigned)> on_start_;
+};
+
+// ------------- 事件：set() 后恢复全部等待者；reset() 供下一轮复用（须无等待者） -------------
+class Event {
+public:
+  void set();
+  void reset();
+
+  auto operator co_await() {
+    struct Awaiter {
+      Event* e;
+      bool await_ready() const noexcept { return false; }
+      bool await_suspend(std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lk(e->mu_);
+        if (e->set_) return false;          // 已完成：不挂起
+        e->waiters_.push_back(h);
+        return true;
+      }
+      void await_resume() const noexcept {}
+    };
+    return Awaiter{this};
+  }
+
+private:
+  std::mutex mu_;
+  bool set_{false};
+  std::vector<std::coroutine_handle<>> waiters_;
+};
+
+// ------------- DAG：节点 + 依赖 + 关键路径报告 -------------
+class Graph {
+public:
+  using NodeId = size_t;
+
+  Graph() = default;
+  ~Graph();
+  Graph(const Graph&) = delete;
+  Graph& operator=(const Graph&) = delete;
+
+  // hint ≥ 0 时节点在 pools[hint % pools.size()] 上执行（亲和提示，如 NUMA 节点）；
+  // 无提示的节点按编号轮流分配
+  NodeId add(std::string name, std::vector<NodeId> deps, std::function<void()> fn, int hint = -1);
+  size_t size() const { return nodes_.size(); }
+
+  struct Report {
+    double wall_ms{0};                    // 实际端到端
+    double work_ms{0};                    // 所有节点耗时之和（≈ 严格串行）
+    double critical_ms{0};                // 最长依赖链耗时
+    std::vector<std::string> critical_path;
+  };
+
+  // 阻塞直到全部节点完成；可重复调用，每次都执行全部节点
+  Report run(Pool& pool) { return run(std::vector<Pool*>{&pool}); }
+  Report run(const std::vector<Pool*>& pools);
+
+  // 丢弃全部节点（形状变化时重建）
+  void clear();
+
+  // 节点实测耗时（run 之后有效）
+  double node_ms(NodeId id) const { return nodes_[id].t1_ms - nodes_[id].t0_ms; }
+  const std::string& node_name(NodeId id) const { return nodes_[id].name; }
+
+private:
+  struct Node {
+    std::string name;
+    std::vector<NodeId> deps;
+    std::function<void()> fn;
+    int hint{-1};
+    Event done;
+    double t0_ms{0}, t1_ms{0};
+    // 协程帧存储：首轮分配，之后各轮原地复用。live 在帧销毁（operator delete）时清零
+    std::unique_ptr<std::byte[]> frame;
+    size_t frame_cap{0};
+    std::atomic<bool> live{false};
+  };
+
+  struct Completion {
+    size_t left{0};
+    std::mutex mu;
+    std::condition_variable cv;
+  };
+
+  // 节点协程：帧放在 Node::frame 里（帧前留一个 Node* 头，销毁时据此清 live）
+  struct Task {
+    struct promise_type {
+      static constexpr size_t kHdr = alignof(std::max_align_t);
+      static void* operator new(size_t sz, Graph&, Node& nd, Pool&, Completion&,
+                                std::chrono::steady_clock::time_point);
+      static void operator delete(void* p, size_t) noexcept;
+      Task get_return_object() noexcept { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() noexcept {}
+      void unhandled_exception() noexcept { std::terminate(); }
+    };
+  };
+
+  static Task drive(Graph& g, Node& nd, Pool& pool, Completion& c,
+                    std::chrono::steady_clock::time_point epoch);
+
+  // 等待上一轮的协程全部销毁帧（它们在通知完成之后才退出）
+  void quiesce();
+
+  std::deque<Node> nodes_;   // Event 不可移动：deque 保证地址稳定
+};
+
+} // namespace sched
@@ -0,0 +1,53 @@
+#pragma once
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+// ================= 二进制集合文件 =================
+// 每方一个文件 <dir>/party_<i>.oset：64 字节头 + 对齐到 64 字节的 Block128 数组（主机字节序）。
+// 元素区可直接 mmap 后按 const Block128* 访问；加载时多线程分块拷贝。
+
+struct SetFileHeader {
+  char     magic[8];      // "OTPSISET"
+  uint32_t version;       // 1
+  uint32_t elem_bytes;    // 16
+  uint64_t count;         // 元素个数
+  uint64_t party_id;      // 参与方编号（1..n）
+  uint64_t data_offset;   // 元素区偏移（64 的倍数）
+  uint64_t reserved[3];
+};
+static_assert(sizeof(SetFileHeader) == 64, "SetFileHeader must be 64 bytes");
+static_assert(sizeof(Block128) == 16, "Block128 must be 16 bytes");
+
+std::string set_file_path(const std::string& dir, int party_id);
+
+// 写出一方集合（先写 .tmp 再 rename）；失败返回 false
+bool write_set_file(const std::string& path, uint64_t party_id, const std::vector<Block128>& xs);
+
+// 只读映射一个集合文件；失败时 ok() 为 false。仅可移动
+class MappedSet {
+public:
+  MappedSet() = default;
+  explicit MappedSet(const std::string& path);
+  ~MappedSet();
+  MappedSet(MappedSet&& o) noexcept;
+  MappedSet& operator=(MappedSet&& o) noexcept;
+  MappedSet(const MappedSet&) = delete;
+  MappedSet& operator=(const MappedSet&) = delete;
+
+  bool ok() const { return data_ != nullptr || (base_ != nullptr && count_ == 0); }
+  const Block128* data() const { return data_; }
+  size_t size() const { return count_; }
+  uint64_t party_id() const { return party_id_; }
+
+private:
+  void*  base_{nullptr};
+  size_t len_{0};
+  const Block128* data_{nullptr};
+  size_t count_{0};
+  uint64_t party_id_{0};
+};
+
+// 并行加载 dir 下 party_1..party_n（n 为连续存在的文件数）到 Xs（下标 1..n，Xs[0] 为空）。
+// threads=0 取硬件并发数；任一文件损坏则返回空向量
+std::vector<std::vector<Block128>> load_set_dir(const std::string& dir, unsigned threads = 0);
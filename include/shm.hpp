@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ================= 进程间共享内存传输 =================
+// 父进程在 fork 之前创建全部共享区（memfd + MAP_SHARED），子进程继承同一映射，
+// 因此各进程看到的地址一致，聚合方可以直接在各方写出的份额表上读取（零拷贝）。
+// 消息走单生产者/单消费者环形缓冲；每方一个门铃（futex 字），有新消息时敲响接收方。
+
+namespace shm {
+
+// CLOCK_MONOTONIC 纳秒：跨进程可比，用于链路单向时延
+uint64_t now_ns();
+
+// ------------- 一块 memfd 共享内存 -------------
+class Region {
+public:
+  Region() = default;
+  // 失败时 ok() 为 false（不抛异常）；内容初始为 0
+  Region(const char* name, size_t bytes);
+  ~Region();
+  Region(Region&& o) noexcept;
+  Region& operator=(Region&& o) noexcept;
+  Region(const Region&) = delete;
+  Region& operator=(const Region&) = delete;
+
+  bool ok() const { return base_ != nullptr; }
+  void* data() const { return base_; }
+  size_t size() const { return len_; }
+  template <class E> E* as(size_t byte_off = 0) const {
+    return reinterpret_cast<E*>(static_cast<char*>(base_) + byte_off);
+  }
+
+private:
+  void*  base_{nullptr};
+  size_t len_{0};
+};
+
+// ------------- 门铃：计数 + 等待者标志，放在共享内存中 -------------
+struct Doorbell {
+  std::atomic<uint32_t> seq{0};
+  std::atomic<uint32_t> waiting{0};
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex word must be lock-free");
+
+void ring(Doorbell& d);
+// seq 未变时最多睡 timeout_ms（防止对端异常退出时永久阻塞）
+void wait(Doorbell& d, uint32_t seen, int timeout_ms);
+
+// ------------- SPSC 环：消息连续存放，尾部放不下时写一条填充并回绕 -------------
+struct MsgHdr {
+  uint32_t bytes;     // 含头、按 8 对齐后的总长
+  uint32_t type;
+  uint32_t count;     // 载荷元素个数
+  uint32_t reserved;
+  uint64_t seq;       // 由协议使用（如批次起始下标）
+  uint64_t send_ns;   // 发送时刻：由 try_push 在载荷写完、发布之前填写
+  uint64_t echo_ns;   // 应答携带的请求发送时刻（往返时延）
+};
+static_assert(sizeof(MsgHdr) % 8 == 0, "MsgHdr must keep 8-byte alignment");
+
+constexpr uint32_t kMsgPad = 0xFFFFFFFFu;
+
+struct RingHdr {
+  alignas(64) std::atomic<uint64_t> head{0};   // 生产者写入位置（单调增）
+  alignas(64) std::atomic<uint64_t> tail{0};   // 消费者读取位置（单调增）
+  alignas(64) uint64_t cap{0};                 // 数据区字节数（8 的倍数）
+};
+
+// 环的视图：hdr 与数据区都在共享内存里，本对象只持有指针，可随意拷贝
+class Ring {
+public:
+  Ring() = default;
+  Ring(RingHdr* h, uint8_t* data) : h_(h), d_(data) {}
+
+  // 数据区所需字节数的上界：至少容纳 max_msgs 条 max_payload 的消息，另留一条作回绕填充
+  static size_t capacity_for(size_t max_payload, size_t max_msgs);
+  static void init(RingHdr* h, size_t cap) { h->cap = cap; }
+
+  // 写一条消息：payload 由 fill(dst) 直接写入环内；空间不足返回 false。
+  // send_ns 在 fill 之后盖戳，链路时延不含生产者生成载荷的时间
+  template <class Fill>
+  bool try_push(const MsgHdr& hdr_in, size_t payload_bytes, Fill&& fill) {
+    const uint64_t cap  = h_->cap;
+    const uint64_t need = align8(sizeof(MsgHdr) + payload_bytes);
+    uint64_t head = h_->head.load(std::memory_order_relaxed);
+    const uint64_t tail = h_->tail.load(std::memory_order_acquire);
+    const uint64_t pos = head % cap;
+    const uint64_t pad = (cap - pos < need) ? cap - pos : 0;
+    if (need + pad > cap - (head - tail)) return false;
+    if (pad) {
+      MsgHdr ph{}; ph.bytes = (uint32_t)pad; ph.type = kMsgPad;
+      std::memcpy(d_ + pos, &ph, sizeof(uint64_t));   // 填充只需 bytes/type
+      head += pad;
+    }
+    uint8_t* dst = d_ + head % cap;
+    MsgHdr hdr = hdr_in;
+    hdr.bytes = (uint32_t)need;
+    std::memcpy(dst, &hdr, sizeof(hdr));
+    fill(dst + sizeof(MsgHdr));
+    const uint64_t sent = now_ns();
+    std::memcpy(dst + offsetof(MsgHdr, send_ns), &sent, sizeof(sent));
+    h_->head.store(head + need, std::memory_order_release);
+    return true;
+  }
+
+  // 查看队首消息（跳过填充）；空则返回 nullptr。载荷紧跟在头之后
+  const MsgHdr* peek() {
+    for (;;) {
+      const uint64_t tail = h_->tail.load(std::memory_order_relaxed);
+      if (tail == h_->head.load(std::memory_order_acquire)) return nullptr;
+      const auto* m = reinterpret_cast<const MsgHdr*>(d_ + tail % h_->cap);
+      if (m->type != kMsgPad) return m;
+      h_->tail.store(tail + m->bytes, std::memory_order_release);
+    }
+  }
+  void pop(const MsgHdr* m) {
+    h_->tail.store(h_->tail.load(std::memory_order_relaxed) + m->bytes, std::memory_order_release);
+  }
+
+private:
+  static uint64_t align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+  RingHdr* h_{nullptr};
+  uint8_t* d_{nullptr};
+};
+
+} // namespace shm
@@ -5,20 +5,36 @@
 #include <string>
 #include <utility>
 
-using u8 = uint8_t; using u64 = uint64_t;
+using u8 = uint8_t; using u32 = uint32_t; using u64 = uint64_t;
 
 struct Block128 { u64 hi{0}, lo{0}; };         // 128-bit 块（GF(2^128) 占位）
 struct Tag128   { u64 hi{0}, lo{0}; };         // 128-bit 标签（哈希到此）
 
 inline bool operator==(const Tag128& a, const Tag128& b){ return a.hi==b.hi && a.lo==b.lo; }
+inline bool operator< (const Tag128& a, const Tag128& b){ return a.hi!=b.hi ? a.hi<b.hi : a.lo<b.lo; }
 
-struct KV { Block128 key; Block128 val; };     // (x, f_x(i))
-struct Share { int party_id; Block128 fx_i; Tag128 tag; };
+// 标签存储类型 T：u32（32 bit）、u64（64 bit）、Tag128（128 bit）。
+// 不提供 48 bit：ShareT 中标签后紧跟 8 字节对齐的值，6 字节标签与 u64 占同样的空间
+// tag_key 把标签压到 64 bit 作为结果集键（128 bit 沿用旧的 hi ^ lo<<1 折叠）
+inline u64 tag_key(u32 t){ return t; }
+inline u64 tag_key(u64 t){ return t; }
+inline u64 tag_key(const Tag128& t){ return t.hi ^ (t.lo<<1); }
+
+// 值类型 V 为域元素（GF(2^128) 用 Block128，GF(2^64) 用 u64），键始终是 128-bit 集合元素
+template <class V> struct KVT { Block128 key; V val; };                  // (x, f_x(i))
+// 成员按 int/T/V 排列以减少填充：u32 标签 + u64 值 = 16 字节
+template <class V, class T = Tag128> struct ShareT { int party_id; T tag; V fx_i; };
 
 struct OKVSParams { size_t m{0}; size_t w{64}; u64 seed_r1{0}; u64 seed_r2{0}; };
 
-struct Bucket { std::vector<Share> items; };
-struct HashTableTi { std::vector<Bucket> table; /* size B */ };
+template <class V, class T = Tag128> struct BucketT { std::vector<ShareT<V, T>> items; };
+template <class V, class T = Tag128> struct HashTableTiT { std::vector<BucketT<V, T>> table; /* size B */ };
+
+// 默认 GF(2^128) 实例（保留旧名）
+using KV          = KVT<Block128>;
+using Share       = ShareT<Block128>;
+using Bucket      = BucketT<Block128>;
+using HashTableTi = HashTableTiT<Block128>;
 
 // 便捷工具
 inline Block128 make_block(u64 hi, u64 lo){ return Block128{hi, lo}; }
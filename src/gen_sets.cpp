@@ -0,0 +1,168 @@
+// gen_sets：生成各方集合文件（party_<i>.oset），供 party 通过 OTPSI_SET_DIR 读取。
+//
+// 模型：每方有共享配额 overlap·目标大小。共享元素逐个生成：先抽“持有方数” c，
+// 再在仍有配额的各方中按剩余配额加权、无放回地选出 c 个持有方，直到配额用尽；
+// 每方集合 = 分到的共享元素 + 补足到目标大小的独有元素。
+// c 只在可行范围（≤ 仍有配额的方数）内抽；尾部不足 k 方时只能出未命中元素，
+// 实际命中率随输出打印，偏离 --hit-rate 时告警。
+//   --skew s         集合大小 ∝ i^-s（归一化到均值 m；0 为等大）
+//   --overlap u      每方集合中共享元素的占比（配额按目标大小取整；c = 1 的元素也占配额，
+//                    但输出的 shared_frac 只统计 ≥ 2 方持有的元素）
+//   --overlap-dist   持有方数在区间内的分布：uniform | zipf（偏向少数持有方）
+//   --hit-rate h     共享元素中持有方数 ≥ k（会被协议输出）的比例
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "types.hpp"
+#include "setfile.hpp"
+
+struct GenOptions {
+  std::string out;
+  int n{10};
+  size_t m{1024};
+  double skew{0.0};
+  double overlap{0.5};
+  std::string overlap_dist{"uniform"};
+  int k{3};
+  double hit_rate{0.5};
+  u64 seed{1};
+};
+
+static void usage(const char* prog) {
+  std::cerr << "usage: " << prog << " --out DIR [--n N] [--m MEAN_SIZE] [--skew S]\n"
+            << "       [--overlap U] [--overlap-dist uniform|zipf] [--k K] [--hit-rate H] [--seed SEED]\n";
+}
+
+static bool parse(int argc, char** argv, GenOptions& o) {
+  for (int a = 1; a < argc; ++a) {
+    std::string key = argv[a];
+    if (a + 1 >= argc) return false;
+    std::string val = argv[++a];
+    if      (key == "--out")          o.out = val;
+    else if (key == "--n")            o.n = std::atoi(val.c_str());
+    else if (key == "--m")            o.m = (size_t)std::atoll(val.c_str());
+    else if (key == "--skew")         o.skew = std::atof(val.c_str());
+    else if (key == "--overlap")      o.overlap = std::atof(val.c_str());
+    else if (key == "--overlap-dist") o.overlap_dist = val;
+    else if (key == "--k")            o.k = std::atoi(val.c_str());
+    else if (key == "--hit-rate")     o.hit_rate = std::atof(val.c_str());
+    else if (key == "--seed")         o.seed = (u64)std::strtoull(val.c_str(), nullptr, 0);
+    else return false;
+  }
+  return !o.out.empty() && o.n >= 1 && o.k >= 1 && o.k <= o.n &&
+         o.overlap >= 0 && o.overlap <= 1 && o.hit_rate >= 0 && o.hit_rate <= 1 &&
+         (o.overlap_dist == "uniform" || o.overlap_dist == "zipf");
+}
+
+// 在 [lo, hi] 上抽持有方数：uniform 等概率；zipf 取 P(c) ∝ (c-lo+1)^-1
+static int draw_count(std::mt19937_64& rng, int lo, int hi, bool zipf) {
+  if (lo >= hi) return lo;
+  if (!zipf) return std::uniform_int_distribution<int>(lo, hi)(rng);
+  std::vector<double> w(hi - lo + 1);
+  for (size_t j = 0; j < w.size(); ++j) w[j] = 1.0 / (double)(j + 1);
+  return lo + (int)std::discrete_distribution<size_t>(w.begin(), w.end())(rng);
+}
+
+int main(int argc, char** argv) {
+  GenOptions o;
+  if (!parse(argc, argv, o)) { usage(argv[0]); return 2; }
+  ::mkdir(o.out.c_str(), 0755);
+
+  std::mt19937_64 rng(o.seed);
+  auto fresh_elem = [&]{ u64 a = rng(); u64 b = rng(); return Block128{a, b}; };
+  const bool zipf = (o.overlap_dist == "zipf");
+  const int n = o.n, k = o.k;
+
+  // ---- 目标集合大小（均值 m，按 i^-skew 分配） ----
+  std::vector<double> w(n + 1, 0.0);
+  for (int i = 1; i <= n; ++i) w[i] = std::pow((double)i, -o.skew);
+  const double wsum = std::accumulate(w.begin() + 1, w.end(), 0.0);
+  std::vector<size_t> target(n + 1, 0);
+  for (int i = 1; i <= n; ++i)
+    target[i] = std::max<size_t>(1, (size_t)std::llround((double)o.m * n * w[i] / wsum));
+
+  // ---- 共享元素：持有方数 c，命中（c ≥ k）占比 hit_rate；未命中 c ∈ [1, k-1] ----
+  // 配额保证每方共享元素数不超过 overlap·目标大小；按剩余配额加权使各方大致同步耗尽
+  const bool has_miss = k > 1;
+  const double hit = has_miss ? o.hit_rate : 1.0;
+  std::vector<size_t> budget(n + 1, 0);
+  for (int i = 1; i <= n; ++i) budget[i] = (size_t)std::llround(o.overlap * (double)target[i]);
+
+  std::vector<std::vector<Block128>> Xs(n + 1);
+  std::vector<size_t> shared(n + 1, 0);  // 每方分到的 ≥ 2 方持有的元素数
+  size_t pool = 0, hits = 0, forced_miss = 0;
+  std::vector<int> open, holders;
+  for (;;) {
+    open.clear();
+    for (int i = 1; i <= n; ++i) if (budget[i]) open.push_back(i);
+    if (open.empty()) break;
+
+    // 截断到可选方数会把 c 堆在 open.size() 上、把命中元素变成未命中；改为在可行区间内抽
+    const int avail = (int)open.size();
+    const bool want_hit = !has_miss || std::bernoulli_distribution(hit)(rng);
+    const bool is_hit = want_hit && avail >= k;
+    forced_miss += (want_hit && !is_hit);
+    const int c = is_hit ? draw_count(rng, k, std::min(n, avail), zipf)
+                         : draw_count(rng, 1, std::min(k - 1, avail), zipf);
+
+    // 无放回加权抽样：每抽中一方即从候选中移除
+    holders.clear();
+    for (int j = 0; j < c; ++j) {
+      size_t sum = 0;
+      for (int p : open) sum += budget[p];
+      size_t r = std::uniform_int_distribution<size_t>(0, sum - 1)(rng);
+      size_t q = 0;
+      while (r >= budget[open[q]]) r -= budget[open[q++]];
+      holders.push_back(open[q]);
+      open.erase(open.begin() + (ptrdiff_t)q);
+    }
+
+    const Block128 x = fresh_elem();
+    for (int p : holders) { Xs[p].push_back(x); --budget[p]; shared[p] += (c >= 2); }
+    ++pool;
+    hits += is_hit;
+  }
+
+  // 共享占比：只算 ≥ 2 方持有的元素（单方持有的与独有元素无异）
+  double share_min = 1.0, share_max = 0.0;
+  for (int i = 1; i <= n; ++i) {
+    const double f = (double)shared[i] / (double)target[i];
+    share_min = std::min(share_min, f);
+    share_max = std::max(share_max, f);
+  }
+
+  // ---- 独有元素补足；打乱顺序避免共享元素聚在前部 ----
+  size_t total = 0;
+  for (int i = 1; i <= n; ++i) {
+    while (Xs[i].size() < target[i]) Xs[i].push_back(fresh_elem());
+    std::shuffle(Xs[i].begin(), Xs[i].end(), rng);
+    if (!write_set_file(set_file_path(o.out, i), (uint64_t)i, Xs[i])) {
+      std::cerr << "failed to write " << set_file_path(o.out, i) << "\n";
+      return 1;
+    }
+    total += Xs[i].size();
+  }
+
+  const double achieved = pool ? (double)hits / (double)pool : 0.0;
+  std::cout << "wrote " << n << " sets to " << o.out << ": total=" << total
+            << " min=" << std::min_element(Xs.begin() + 1, Xs.end(),
+                 [](auto& a, auto& b){ return a.size() < b.size(); })->size()
+            << " max=" << std::max_element(Xs.begin() + 1, Xs.end(),
+                 [](auto& a, auto& b){ return a.size() < b.size(); })->size()
+            << " shared_pool=" << pool << " threshold_hits(k=" << k << ")=" << hits
+            << " hit_rate=" << achieved
+            << " shared_frac=[" << share_min << "," << share_max << "]\n";
+  if (has_miss && pool && std::fabs(achieved - hit) > 0.01)
+    std::cerr << "warning: achieved hit rate " << achieved << " misses --hit-rate " << hit
+              << " (" << forced_miss << " hits infeasible: fewer than k=" << k
+              << " parties had shared budget left)\n";
+  return 0;
+}
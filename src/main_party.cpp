@@ -7,6 +7,13 @@
 #include <chrono>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // ===== 你项目已有的头文件 =====
 #include "types.hpp"
@@ -17,10 +24,19 @@
 #include "layout.hpp"
 #include "wire.hpp"
 #include "lagrange.hpp"
+#include "field.hpp"
+#include "run_cache.hpp"
+#include "sched.hpp"
+#include "setfile.hpp"
+#include "run_context.hpp"
+#include "shm.hpp"
+#include "numa_topo.hpp"
 
 // —— 分阶段计时结构 —— //
 struct Timings {
   double s12_ms{}, s13_ms{}, s14_ms{}, s31_ms{}, total_ms{};
+  double work_ms{}, crit_ms{};     // DAG：节点耗时之和 / 关键路径
+  std::string crit_path;           // 关键路径节点名，以 '>' 连接
 };
 
 // *** COMM *** 新增通信统计结构
@@ -30,21 +46,590 @@ struct Comm {
     uint64_t total() const { return S13 + S14; }
 };
 
+// 多进程模式下每条有向链路 src→dst 的实测量（下标 src·(n+1)+dst）
+struct LinkStat {
+    uint64_t bytes = 0, msgs = 0;           // 载荷字节与消息数（接收方记录）
+    uint64_t lat_sum_ns = 0, lat_max_ns = 0;// 单向时延：接收时刻 − 发送时刻
+    uint64_t rtt_sum_ns = 0, rtt_n = 0;     // src 发起的查询批次往返（src 记录）
+};
+
+// NUMA 模式下一次运行的访问计数（软件计数，按“所读数据的归属节点 = 执行线程所在节点”判定本地）
+// 本地/跨节点按实测判定：执行线程当前所在节点（getcpu）与所读内存实际驻留的节点（move_pages 查询）
+// 一致才算本地；查询失败或页尚未分配都计为跨节点。单节点时全部为本地
+struct NumaCounts {
+    uint64_t s14_local = 0, s14_remote = 0;   // S14 解码次数：所读 OKVS（拷贝、副本或原表）是否与执行线程同节点
+    uint64_t s31_local = 0, s31_remote = 0;   // S31 读桶次数（方×桶）：该方份额表是否与执行线程同节点
+    size_t replicated = 0;                    // 本次复制到其他节点的对方表个数
+    size_t bind_failed = 0;                   // 本次使用的 NodeBuffer 中 mbind 失败的个数
+};
+
+// NUMA 模式的运行环境：拓扑、每节点一个绑核线程池、跨重复运行复用的副本缓冲
+struct NumaSetup {
+    numa::Topology topo;
+    std::vector<std::unique_ptr<sched::Pool>> pools;   // pools[nd] 的工作线程绑定在节点 nd
+    std::vector<sched::Pool*> pool_ptrs;
+    numa::Pages pages = numa::Pages::Normal;
+    size_t replica_budget = 0;                          // 全部副本的字节上限
+    std::vector<std::vector<numa::NodeBuffer>> replicas;   // replicas[nd][g]
+    // 节点本地映射（NodeBuffer：mmap + mbind，可用大页），跨重复运行复用：
+    std::vector<numa::NodeBuffer> home;   // home[g]：g 的 OKVS 表在 node_of(g) 上的拷贝，S14 读它而非堆上的原表
+    std::vector<numa::NodeBuffer> sig;    // sig[i]：第 i 方的 σ 暂存（DAG 全量）
+
+    int node_of(int i) const { return (i-1) % topo.nodes(); }   // 紧凑序号：选线程池 / 副本
+    int node_id(int i) const { return topo.ids[node_of(i)]; }    // 真实编号：交给 NodeBuffer（mbind）
+
+    size_t threads() const {
+        size_t t = 0;
+        for (auto* p : pool_ptrs) t += p->size();
+        return t;
+    }
+
+    // 选择要复制的表：跨节点查询次数 / 复制字节数 从高到低，直到用完预算。
+    // 未选中的表的旧副本随即释放，映射总量不超过预算
+    std::vector<char> choose_replicas(const std::vector<OKVSParams>& params,
+                                      const std::vector<std::vector<Block128>>& Xs, size_t elem_bytes){
+        const int n = (int)params.size() - 1, nodes = topo.nodes();
+        std::vector<char> pick(n+1, 0);
+        replicas.resize(nodes);
+        for (auto& r : replicas) r.resize(n+1);   // 缩小时一并释放多出的方
+        if (nodes < 2) return pick;
+
+        std::vector<std::pair<double, int>> order;
+        for (int g=1; g<=n; ++g) {
+            uint64_t remote_q = 0;
+            for (int i=1; i<=n; ++i) if (i != g && node_of(i) != node_of(g)) remote_q += Xs[i].size();
+            const double bytes = (double)params[g].m * elem_bytes * (nodes - 1);
+            if (remote_q) order.push_back({ (double)remote_q / bytes, g });
+        }
+        std::sort(order.begin(), order.end(), [](auto& a, auto& b){ return a.first > b.first; });
+        size_t used = 0;
+        for (auto& [score, g] : order) {
+            const size_t bytes = params[g].m * elem_bytes * (size_t)(nodes - 1);
+            if (used + bytes > replica_budget) continue;
+            used += bytes;
+            pick[g] = 1;
+        }
+        for (int g=1; g<=n; ++g)
+            if (!pick[g]) for (auto& r : replicas) r[g] = numa::NodeBuffer{};
+        return pick;
+    }
+};
+
 // 简便构造 Block128
 static inline Block128 X(u64 a, u64 b){ return Block128{a,b}; }
 
-// —— 单次跑完整流程 —— //
-static double run_once(
-    int n, int S, int k,
-    double eps_okvs, uint32_t w, double eps_hash,
-    u64 salt_tag,
-    Timings* t = nullptr,
-    Comm* comm = nullptr   // *** COMM ***
+constexpr u64 poly_salt = 0xC0FFEEULL;   // 固定全局盐(只用于多项式系数)
+
+// 第 i 方的 OKVS 参数（只依赖 |X_i| 与 i，S12 之前即可确定，供缓存键使用）
+static OKVSParams okvs_params_for(int i, size_t ni, double eps_okvs, uint32_t w){
+  OKVSParams p;
+  p.m = static_cast<size_t>(std::ceil((1.0 + eps_okvs) * ni));
+  if (p.m < (size_t)w + 1) p.m = (size_t)w + 1;
+  p.w = w;
+  p.seed_r1 = 0xA1B2C3D400000000ULL ^ (uint64_t)i;
+  p.seed_r2 = 0x0F1E2D3C00000000ULL ^ ((uint64_t)i << 8);
+  return p;
+}
+
+// ====== 阶段函数（顺序路径与 DAG 路径共用） ======
+
+// 第 g 方的插值横坐标 α_g：S12 求值与 S31 插值必须用同一个
+template <Field F>
+static inline typename F::Elem alpha_of(int g){ return F::hash_to_field_u64((u64)g); }
+
+// 标签由秘密 f_x(0) = embed(x) 导出（GF128 下即 x），S31 可用重构出的秘密重算标签
+template <Field F, class T>
+static inline T secret_tag(const typename F::Elem& s, u64 salt_tag, int tag_bits){
+  return tag_of_bits<T>(F::lift(s), salt_tag, tag_bits);
+}
+
+// S12：第 i 方对自己集合的每个 x 计算 (x, f_x(α_i)) 与 tag_bits 位标签
+template <Field F, class T>
+static void s12_party(int i, int k, u64 salt_tag, int tag_bits, const std::vector<Block128>& Xi,
+                      std::vector<KVT<typename F::Elem>>& kv, std::vector<T>& tags){
+  using V = typename F::Elem;
+  const V alpha_i = alpha_of<F>(i);
+  kv.reserve(Xi.size());
+  tags.reserve(Xi.size());
+  std::vector<V> coeff;                      // 多项式系数暂存，整方共用
+  for(const auto& x : Xi){
+    PRG prg(mix_seed(x, poly_salt));         // 只依赖 x
+    const V secret = F::embed(x);
+    V fxi = poly_eval_at<F>(secret, alpha_i, k, prg, coeff);
+    kv.push_back({x, fxi});
+    tags.push_back(secret_tag<F, T>(secret, salt_tag, tag_bits));
+  }
+}
+
+// 流式 S14：第 i 方只放置落在块 c = [lo, hi) 的份额，σ 只对这些份额向对方查询。
+// 只遍历分块索引 ci 中涉及本块的元素；table_of(g) 给出解码 g 时读取的存储（原表或节点本地副本）
+template <class V, class T, class TableOf>
+static void s14_place_range(const EncodedPartiesT<V, T>& E, int n, int i, size_t B, u64 salt_tag,
+                            const ChunkIndex& ci, size_t c, size_t lo, size_t hi,
+                            HashTableTiT<V, T>& Tc, std::vector<size_t>& pos, TableOf&& table_of){
+  const auto& kv = E.kv_all[i];
+  for(size_t e=ci.off[c]; e<ci.off[c+1]; ++e){
+    const size_t j = ci.idx[e];
+    const Block128& x = kv[j].key;
+    insert_element_Ti_range(Tc, lo, hi, B, n, i, x, E.tag_all[i][j], kv[j].val,
+                            [&](int g){ return RBOKVST<V>::DecodeAt(E.okvs[g].p, table_of(g), x); },
+                            salt_tag, pos);
+  }
+}
+
+// S31：在桶区间 [lo, hi) 上按标签分组并重构，把通过校验的标签追加到 sc.out（可能重复）。
+// items_of(i, eta) 返回第 i 方第 eta 号桶的份额 {指针, 个数}，表的存放方式由调用方决定。
+// 分组直接按紧凑标签排序：同标签份额连续，同方重复份额相邻，无需哈希表与去重集合。
+// 校验：前 k 个不同标号的点插值出 f，多余的点须全部落在 f 上；恰好 k 个点时插值恒成立，
+// 因此还要求秘密 f(0) 重算出的标签等于本组标签——混入随机 σ 的组两项都过不了
+template <Field F, class T, class ItemsOf>
+static void s31_range_by(ItemsOf&& items_of, int n, int k, u64 salt_tag, int tag_bits,
+                         size_t lo, size_t hi, S31ScratchT<typename F::Elem, T>& sc){
+  using V = typename F::Elem;
+  using Sh = ShareT<V, T>;
+
+  auto& pool  = sc.pool;
+  auto& pts   = sc.pts;
+  auto& extra = sc.extra;
+
+  for(size_t eta=lo; eta<hi; ++eta){
+    pool.clear();
+    for(int i=1;i<=n;++i){
+      auto [items, cnt] = items_of(i, eta);
+      pool.insert(pool.end(), items, items + cnt);
+    }
+
+    std::sort(pool.begin(), pool.end(), [](const Sh& a, const Sh& b){
+      if (a.tag < b.tag) return true;
+      if (b.tag < a.tag) return false;
+      return a.party_id < b.party_id;
+    });
+
+    for(size_t lo_g=0; lo_g<pool.size(); ){
+      size_t hi_g = lo_g + 1;
+      while(hi_g < pool.size() && pool[hi_g].tag == pool[lo_g].tag) ++hi_g;
+
+      pts.clear(); extra.clear();
+      for(size_t q=lo_g; q<hi_g; ++q){
+        if(q>lo_g && pool[q].party_id == pool[q-1].party_id) continue;
+        ((int)pts.size() < k ? pts : extra).push_back({ alpha_of<F>(pool[q].party_id), pool[q].fx_i });
+      }
+
+      if((int)pts.size() >= k){
+        lagrange_weights<F>(pts, sc.w);
+        bool ok = secret_tag<F, T>(lagrange_eval<F>(pts, sc.w, F::zero()), salt_tag, tag_bits) == pool[lo_g].tag;
+        for(size_t e=0; ok && e<extra.size(); ++e)
+          ok = F::eq(lagrange_eval<F>(pts, sc.w, extra[e].first), extra[e].second);
+
+        if(ok) sc.out.push_back(tag_key(pool[lo_g].tag));
+      }
+      lo_g = hi_g;
+    }
+  }
+}
+
+// 进程内份额表：Ts[i].table 的下标相对 base（全量表 base=0，流式块 base=块起点）
+template <Field F, class T>
+static void s31_range(const std::vector<HashTableTiT<typename F::Elem, T>>& Ts, int n, int k,
+                      u64 salt_tag, int tag_bits,
+                      size_t lo, size_t hi, size_t base, S31ScratchT<typename F::Elem, T>& sc){
+  s31_range_by<F, T>([&](int i, size_t eta){
+    const auto& items = Ts[i].table[eta - base].items;
+    return std::make_pair(items.data(), items.size());
+  }, n, k, salt_tag, tag_bits, lo, hi, sc);
+}
+
+// 流式模式每块桶数：从 mem_ceiling 中扣除常驻的 S12/S13 产物，剩余预算由 inflight 个块平分；
+// 每桶期望份额数为 n·Σ|X_i| / B，按 2 倍估算以覆盖 vector 增长与负载不均。
+// 上限连 inflight 个单桶块都放不下时仍返回 1（最慢的切法，实际占用会超过上限），
+// 并把可行的最小上限（常驻 + inflight 个单桶块）写入 *min_ceiling；可行时写 0
+template <class V, class T>
+static size_t stream_chunk_buckets(size_t mem_ceiling, size_t resident, int n,
+                                   size_t total_elems, size_t B, int inflight,
+                                   size_t* min_ceiling){
+  const double shares_per_bucket = (double)n * (double)total_elems / (double)B;
+  const double bytes_per_bucket  = (double)(n+1) * sizeof(BucketT<V, T>)
+                                 + 2.0 * shares_per_bucket * sizeof(ShareT<V, T>);
+  const size_t need = resident + (size_t)std::ceil(bytes_per_bucket * inflight);
+  *min_ceiling = (mem_ceiling < need) ? need : 0;
+  if (mem_ceiling <= resident) return 1;
+  const double budget = (double)(mem_ceiling - resident) / (double)inflight;
+  size_t c = (size_t)(budget / bytes_per_bucket);
+  return std::clamp<size_t>(c, 1, B);
+}
+
+// —— DAG 执行：按细粒度依赖重叠 S12/S13/S14/S31 —— //
+// 节点：S12[i] → S13[i]；S14[i←g] 依赖 S12[i] 与 S13[g]；Place[i] 依赖全部 S14[i←*]；
+// S31 按桶区间切块，依赖全部 Place。缓存命中时没有 S12/S13 节点。
+// chunk_buckets>0 为流式模式：Bin[i] 先建第 i 方的分块索引，块 c 的 Place[i]@c 只遍历涉及本块的元素，
+// 直接按需 Decode 并只放置本块份额，
+// S31@c 依赖本块全部 Place，Release@c 清空块缓冲；块 c 依赖 Release@(c-2)（双缓冲）。
+// stage_ms 返回各阶段节点耗时之和（不再是屏障间隔）。
+// 份额表、σ 暂存与 S31 暂存都取自 ctx（已在 run_once 中按形状 reset），结果写入 ctx.result。
+// numa 非空（多节点）时：第 i 方的节点都提示到 node_of(i) 的线程池；OKVS 由 Home[g] 拷到 node_of(g)
+// 的 NodeBuffer，σ 暂存也用 NodeBuffer，选中的对方表另建 Rep[g]@nd 复制到其他节点，S14 就近读取。
+// 份额表仍是堆上的 std::vector，不做 mbind（策略会残留在释放后的堆区间上）；桶数组与份额存储
+// 都由绑核的 Place[i] 分配并首次触碰（reset 的 defer_tables）。
+// nc 记录本地/跨节点访问次数。
+//
+// 图本身跨重复运行复用（DagPlan）：形状键相同则直接重跑上一张图，节点名、函数与协程帧都不再分配；
+// 节点函数只捕获形状常量（i、g、桶区间等），每次运行变化的数据一律经 DagPlan 的绑定读取。
+template <class V, class T>
+struct DagPlan {
+  using NodeId = sched::Graph::NodeId;
+
+  sched::Graph G;
+  std::vector<u64> shape;   // 构图时的形状键；不同则重建
+  std::vector<NodeId> s12_nodes, s13_nodes, rep_nodes, s14_nodes, s31_nodes;
+
+  // —— 本次运行的绑定（run_dag 开头更新） ——
+  RunContextT<V, T>* ctx{nullptr};
+  const EncodedPartiesT<V, T>* E{nullptr};
+  EncodedPartiesT<V, T>* fresh{nullptr};    // 未命中：由 S12/S13 节点填充
+  const std::vector<std::vector<Block128>>* Xs{nullptr};
+  const std::vector<OKVSParams>* params{nullptr};
+  int k{0}, tag_bits{0};
+  u64 salt_tag{0};
+  NumaSetup* numa{nullptr};
+  bool counting{false};
+  std::vector<char> replicated;              // 选中复制（属于形状键，运行中只读）
+  std::vector<std::vector<char>> rep_ok;     // rep_ok[g][nd]：只由 Rep[g]@nd 写、其下游读；每次清零
+  std::vector<char> home_ok;                 // home_ok[g]：只由 Home[g] 写；每次清零
+  std::vector<V*> sig_at;                    // sig_at[i]：第 i 方 σ 暂存（NodeBuffer 或 ctx.sig）
+  std::atomic<uint64_t> s14_local{0}, s14_remote{0}, s31_local{0}, s31_remote{0};
+
+  bool multi() const { return numa && numa->topo.multi(); }
+
+  // 第 i 方解码 g 的表时读取的存储：本节点的副本 > g 节点上的拷贝 > 堆上的原表（拷贝失败时）
+  const V* table_for(int i, int g) const {
+    if (!multi()) return E->okvs[g].S.data();
+    const int nd = numa->node_of(i);
+    if (nd != numa->node_of(g) && replicated[g] && rep_ok[g][nd]) return numa->replicas[nd][g].template as<V>();
+    if (home_ok[g]) return numa->home[g].template as<V>();
+    return E->okvs[g].S.data();
+  }
+  // 第 i 方此刻读 g 的表是否本地（实测，见 NumaCounts）
+  bool is_local(int i, int g) const {
+    if (!multi()) return true;
+    const int here = numa::current_node();
+    return here >= 0 && numa::region_node(table_for(i, g), E->okvs[g].byte_size()) == here;
+  }
+  // S31 区间 [a, b) 读各方份额表：每方查询桶数组两端与区间内至多 14 个桶的份额存储
+  void count_s31(int n, const std::vector<HashTableTiT<V, T>>& Ts, size_t a, size_t b, size_t base) {
+    if (!counting) return;
+    if (!multi()) { s31_local += (uint64_t)n * (b - a); return; }
+    const int here = numa::current_node();
+    uint64_t loc = 0, rem = 0;
+    for(int i=1; i<=n; ++i){
+      const auto& tbl = Ts[i].table;
+      const void* addrs[16];
+      size_t cnt = 0;
+      addrs[cnt++] = &tbl[a - base];
+      addrs[cnt++] = &tbl[b - 1 - base];
+      for(size_t q=0; q<14; ++q){
+        const auto& items = tbl[a - base + (b - a) * q / 14].items;
+        if (!items.empty()) addrs[cnt++] = items.data();
+      }
+      (here >= 0 && numa::pages_node(addrs, cnt) == here ? loc : rem) += b - a;
+    }
+    s31_local += loc; s31_remote += rem;
+  }
+};
+
+// 按形状构图：只在形状键变化时调用
+template <Field F, class T>
+static void dag_build(DagPlan<typename F::Elem, T>& plan, int n, size_t B, size_t chunk_buckets, bool fresh){
+  using NodeId = sched::Graph::NodeId;
+  using V = typename F::Elem;
+  auto* P = &plan;
+  sched::Graph& G = plan.G;
+  G.clear();
+  plan.s12_nodes.clear(); plan.s13_nodes.clear(); plan.rep_nodes.clear();
+  plan.s14_nodes.clear(); plan.s31_nodes.clear();
+
+  NumaSetup* numa = plan.numa;
+  const bool multi = plan.multi();
+  auto hint = [&](int i){ return numa ? numa->node_of(i) : -1; };
+  const auto& replicated = plan.replicated;
+  plan.rep_ok.assign(n+1, {});
+  plan.home_ok.assign(n+1, 0);
+
+  std::vector<NodeId> s12_id(n+1), s13_id(n+1);
+  if (fresh) {
+    for(int i=1; i<=n; ++i){
+      s12_id[i] = G.add("S12[" + std::to_string(i) + "]", {}, [P, i]{
+        s12_party<F, T>(i, P->k, P->salt_tag, P->tag_bits, (*P->Xs)[i],
+                        P->fresh->kv_all[i], P->fresh->tag_all[i]);
+      }, hint(i));
+      s13_id[i] = G.add("S13[" + std::to_string(i) + "]", {s12_id[i]}, [P, i]{
+        RBOKVST<V>::EncodeInto(P->fresh->okvs[i], P->fresh->kv_all[i], (*P->params)[i],
+                               P->ctx->enc_scratch[i]);
+      }, hint(i));
+      plan.s12_nodes.push_back(s12_id[i]);
+      plan.s13_nodes.push_back(s13_id[i]);
+    }
+  }
+
+  // Home[g]：把 g 的表拷到 node_of(g) 的 NodeBuffer；Rep[g]@nd：复制到节点 nd 的缓冲。
+  // 都在目标节点上执行，首次触碰即本地；映射失败则下游退回读堆上的原表
+  std::vector<NodeId> home_id(n+1, (NodeId)-1);
+  std::vector<std::vector<NodeId>> rep_id(n+1);
+  if (multi) {
+    for(int g=1; g<=n; ++g){
+      std::vector<NodeId> deps;
+      if (fresh) deps = { s13_id[g] };
+      home_id[g] = G.add("Home[" + std::to_string(g) + "]", std::move(deps), [P, g]{
+        const auto& src = P->E->okvs[g];
+        auto& buf = P->numa->home[g];
+        if (buf.ensure(src.byte_size(), P->numa->node_id(g), P->numa->pages)) {
+          std::memcpy(buf.data(), src.S.data(), src.byte_size());
+          P->home_ok[g] = 1;
+        }
+      }, hint(g));
+      plan.rep_nodes.push_back(home_id[g]);
+    }
+    for(int g=1; g<=n; ++g){
+      if (!replicated[g]) continue;
+      rep_id[g].assign(numa->topo.nodes(), (NodeId)-1);
+      plan.rep_ok[g].assign(numa->topo.nodes(), 0);
+      for(int nd=0; nd<numa->topo.nodes(); ++nd){
+        if (nd == numa->node_of(g)) continue;
+        std::vector<NodeId> deps;
+        if (fresh) deps = { s13_id[g] };
+        rep_id[g][nd] = G.add("Rep[" + std::to_string(g) + "]@" + std::to_string(nd), std::move(deps),
+          [P, g, nd]{
+            const auto& src = P->E->okvs[g];
+            auto& buf = P->numa->replicas[nd][g];
+            if (buf.ensure(src.byte_size(), P->numa->topo.ids[nd], P->numa->pages)) {
+              std::memcpy(buf.data(), src.S.data(), src.byte_size());
+              P->rep_ok[g][nd] = 1;
+            }
+          }, nd);
+        plan.rep_nodes.push_back(rep_id[g][nd]);
+      }
+    }
+  }
+  // 第 i 方读 g 的表之前必须完成的拷贝/复制节点
+  auto rep_dep = [&](int i, int g, std::vector<NodeId>& deps){
+    if (!multi) return;
+    deps.push_back(home_id[g]);
+    if (replicated[g] && numa->node_of(i) != numa->node_of(g))
+      deps.push_back(rep_id[g][numa->node_of(i)]);
+  };
+  const int nodes = numa ? numa->topo.nodes() : 1;
+  auto& ctx = *plan.ctx;
+
+  if (chunk_buckets == 0) {
+    std::vector<NodeId> place_id;
+    for(int i=1; i<=n; ++i){
+      std::vector<NodeId> s14_i;
+      for(int g=1; g<=n; ++g){
+        if(g==i) continue;
+        std::vector<NodeId> deps;
+        if (fresh) deps = { s12_id[i], s13_id[g] };
+        rep_dep(i, g, deps);
+        // σ 暂存：sig[i][j*(n+1)+g] = okvs[g].Decode(x_j)，不同 g 写不同列，无竞争
+        s14_i.push_back(G.add(
+          "S14[" + std::to_string(i) + "<-" + std::to_string(g) + "]", std::move(deps),
+          [P, n, i, g]{
+            const auto& E = *P->E;
+            const auto& kv = E.kv_all[i];
+            V* sig = P->sig_at[i];
+            const V* S = P->table_for(i, g);
+            for(size_t j=0; j<kv.size(); ++j)
+              sig[j*(n+1) + g] = RBOKVST<V>::DecodeAt(E.okvs[g].p, S, kv[j].key);
+            if (P->counting) (P->is_local(i, g) ? P->s14_local : P->s14_remote) += kv.size();
+          }, hint(i)));
+      }
+      plan.s14_nodes.insert(plan.s14_nodes.end(), s14_i.begin(), s14_i.end());
+      place_id.push_back(G.add("Place[" + std::to_string(i) + "]", std::move(s14_i), [P, n, i, B]{
+        const auto& E = *P->E;
+        auto& ctx = *P->ctx;
+        const auto& kv = E.kv_all[i];
+        const V* sig = P->sig_at[i];
+        auto& sigmas = ctx.sigmas[i];
+        auto& Ts = ctx.tables[0].Ts;
+        ctx.ensure_table(Ts[i]);
+        for(size_t j=0; j<kv.size(); ++j){
+          sigmas.clear();
+          for(int g=1; g<=n; ++g) if(g!=i) sigmas.emplace_back(g, sig[j*(n+1) + g]);
+          insert_element_Ti(Ts[i], B, n, i, kv[j].key, E.tag_all[i][j], kv[j].val, sigmas,
+                            P->salt_tag, ctx.tables[0].pos[i]);
+        }
+      }, hint(i)));
+    }
+    plan.s14_nodes.insert(plan.s14_nodes.end(), place_id.begin(), place_id.end());
+
+    const size_t chunks = ctx.s31.size();
+    for(size_t c=0; c<chunks; ++c){
+      size_t lo = B * c / chunks, hi = B * (c+1) / chunks;
+      const int h = numa ? (int)(c % nodes) : -1;
+      plan.s31_nodes.push_back(G.add("S31[" + std::to_string(lo) + "," + std::to_string(hi) + ")", place_id,
+        [P, n, c, lo, hi]{
+          const auto& Ts = P->ctx->tables[0].Ts;
+          P->count_s31(n, Ts, lo, hi, 0);
+          s31_range<F, T>(Ts, n, P->k, P->salt_tag, P->tag_bits, lo, hi, 0, P->ctx->s31[c]);
+        }, h));
+    }
+  } else {
+    // 块 c 使用第 c % groups 组缓冲与对应的 S31 暂存；同组的块经 Release 串行，互不重叠
+    const size_t nchunks = (B + chunk_buckets - 1) / chunk_buckets;
+    const size_t groups = ctx.tables.size();
+    const size_t sub = ctx.s31.size() / groups;
+
+    // Bin[i]：第 i 方的分块索引，只依赖本方的 S12 产物；位置暂存借用第 0 组（Place[i] 都在其后）
+    std::vector<NodeId> bin_id(n+1);
+    for(int i=1; i<=n; ++i){
+      std::vector<NodeId> deps;
+      if (fresh) deps = { s12_id[i] };
+      bin_id[i] = G.add("Bin[" + std::to_string(i) + "]", std::move(deps), [P, n, i, B, chunk_buckets]{
+        auto& ctx = *P->ctx;
+        build_chunk_index(ctx.chunk_idx[i], P->E->kv_all[i], n, P->salt_tag, B, chunk_buckets,
+                          ctx.tables[0].pos[i]);
+      }, hint(i));
+      plan.s14_nodes.push_back(bin_id[i]);
+    }
+
+    std::vector<NodeId> release_id;
+    for(size_t c=0; c<nchunks; ++c){
+      const size_t lo = c * chunk_buckets, hi = std::min(B, lo + chunk_buckets);
+      const size_t grp = c % groups;
+      const std::string tagc = "@" + std::to_string(c);
+
+      std::vector<NodeId> place_c;
+      for(int i=1; i<=n; ++i){
+        std::vector<NodeId> deps;
+        if (fresh) deps = plan.s13_nodes;            // 需要全部对方的 OKVS（含 S13[i] ⇒ S12[i]）
+        deps.push_back(bin_id[i]);
+        for(int g=1; g<=n; ++g) if (g != i) rep_dep(i, g, deps);
+        if (c >= groups) deps.push_back(release_id[c - groups]);
+        place_c.push_back(G.add("Place[" + std::to_string(i) + "]" + tagc, std::move(deps),
+          [P, n, i, B, c, lo, hi, grp]{
+            auto& Tc = P->ctx->tables[grp];
+            P->ctx->ensure_table(Tc.Ts[i]);
+            // 每张表的本地性在本节点开头查一次（逐次解码查询代价过高）；线程局部暂存，不再分配
+            static thread_local std::vector<char> local_g;
+            local_g.assign(n+1, 0);
+            if (P->counting) for(int g=1; g<=n; ++g) if (g != i) local_g[g] = P->is_local(i, g);
+            uint64_t loc = 0, rem = 0;
+            s14_place_range(*P->E, n, i, B, P->salt_tag, P->ctx->chunk_idx[i], c, lo, hi,
+                            Tc.Ts[i], Tc.pos[i], [&](int g){
+              if (P->counting) ++(local_g[g] ? loc : rem);
+              return P->table_for(i, g);
+            });
+            P->s14_local += loc; P->s14_remote += rem;
+          }, hint(i)));
+      }
+      plan.s14_nodes.insert(plan.s14_nodes.end(), place_c.begin(), place_c.end());
+
+      std::vector<NodeId> s31_c;
+      for(size_t s=0; s<sub; ++s){
+        size_t a = lo + (hi - lo) * s / sub, b = lo + (hi - lo) * (s+1) / sub;
+        if (a == b) continue;
+        const int h = numa ? (int)((c * sub + s) % nodes) : -1;
+        s31_c.push_back(G.add("S31[" + std::to_string(a) + "," + std::to_string(b) + ")", place_c,
+          [P, n, a, b, lo, grp, slot = grp*sub + s]{
+            const auto& Ts = P->ctx->tables[grp].Ts;
+            P->count_s31(n, Ts, a, b, lo);
+            s31_range<F, T>(Ts, n, P->k, P->salt_tag, P->tag_bits, a, b, lo, P->ctx->s31[slot]);
+          }, h));
+      }
+      plan.s31_nodes.insert(plan.s31_nodes.end(), s31_c.begin(), s31_c.end());
+      release_id.push_back(G.add("Release" + tagc, std::move(s31_c),
+        [P, grp]{ RunContextT<V, T>::clear_tables(P->ctx->tables[grp].Ts); }));
+    }
+  }
+}
+
+template <Field F, class T>
+static sched::Graph::Report run_dag(
+    DagPlan<typename F::Elem, T>& plan,
+    sched::Pool& pool, int n, int k, u64 salt_tag, int tag_bits, size_t B,
+    const std::vector<std::vector<Block128>>& Xs,
+    const std::vector<OKVSParams>& params,
+    EncodedPartiesT<typename F::Elem, T>* fresh,         // 未命中：由 DAG 填充
+    const EncodedPartiesT<typename F::Elem, T>* cached,  // 命中：只读
+    size_t chunk_buckets,                  // 0 = 全量 Ts
+    RunContextT<typename F::Elem, T>& ctx,
+    double stage_ms[4],
+    NumaSetup* numa = nullptr,
+    NumaCounts* nc = nullptr
 ){
-  using clk = std::chrono::high_resolution_clock;
-  auto g0 = clk::now();   // 开始
+  using NodeId = sched::Graph::NodeId;
+  using V = typename F::Elem;
+  const EncodedPartiesT<V, T>& E = fresh ? *fresh : *cached;
+
+  // ---- NUMA：副本选择（运行前确定）；节点本地缓冲按本次大小就位（容量够则复用） ----
+  const bool multi = numa && numa->topo.multi();
+  std::vector<char> replicated(n+1, 0);
+  if (multi) {
+    replicated = numa->choose_replicas(params, Xs, sizeof(V));
+    numa->home.resize(n+1);
+    numa->sig.resize(n+1);
+  }
+  // σ 暂存：多节点放在第 i 方节点的 NodeBuffer（映射失败则退回 ctx.sig），否则用 ctx.sig
+  plan.sig_at.assign(n+1, nullptr);
+  if (chunk_buckets == 0) {
+    for(int i=1; i<=n; ++i){
+      const size_t cnt = Xs[i].size() * (size_t)(n+1);
+      if (multi && numa->sig[i].ensure(cnt * sizeof(V), numa->node_id(i), numa->pages)) {
+        plan.sig_at[i] = numa->sig[i].template as<V>();
+      } else {
+        ctx.sig[i].resize(cnt);
+        plan.sig_at[i] = ctx.sig[i].data();
+      }
+    }
+  }
+
+  // ---- 本次绑定 ----
+  plan.ctx = &ctx; plan.E = &E; plan.fresh = fresh;
+  plan.Xs = &Xs; plan.params = &params;
+  plan.k = k; plan.tag_bits = tag_bits; plan.salt_tag = salt_tag;
+  plan.numa = numa; plan.counting = (nc != nullptr);
+  plan.s14_local = 0; plan.s14_remote = 0; plan.s31_local = 0; plan.s31_remote = 0;
+
+  // ---- 形状键：决定节点集合与依赖的全部参数 ----
+  std::vector<u64> shape = { (u64)n, (u64)B, (u64)chunk_buckets, (u64)ctx.tables.size(),
+                             (u64)ctx.s31.size(), (u64)(fresh != nullptr),
+                             (u64)(numa ? numa->topo.nodes() : 0) };
+  shape.insert(shape.end(), replicated.begin(), replicated.end());
+  if (shape != plan.shape) {
+    plan.replicated = std::move(replicated);
+    dag_build<F, T>(plan, n, B, chunk_buckets, fresh != nullptr);
+    plan.shape = std::move(shape);
+  } else {
+    for (auto& ok : plan.rep_ok) std::fill(ok.begin(), ok.end(), 0);
+    std::fill(plan.home_ok.begin(), plan.home_ok.end(), 0);
+  }
+
+  auto rep = numa ? plan.G.run(numa->pool_ptrs) : plan.G.run(pool);
+  ctx.collect_result();
+
+  auto sum = [&](const std::vector<NodeId>& ids){
+    double a = 0; for(NodeId id : ids) a += plan.G.node_ms(id); return a;
+  };
+  stage_ms[0] = sum(plan.s12_nodes); stage_ms[1] = sum(plan.s13_nodes) + sum(plan.rep_nodes);
+  stage_ms[2] = sum(plan.s14_nodes); stage_ms[3] = sum(plan.s31_nodes);
+  if (nc) {
+    nc->s14_local = plan.s14_local; nc->s14_remote = plan.s14_remote;
+    nc->s31_local = plan.s31_local; nc->s31_remote = plan.s31_remote;
+    nc->replicated = (size_t)std::count(plan.replicated.begin() + 1, plan.replicated.end(), 1);
+    nc->bind_failed = 0;
+    if (multi) {
+      for(int g=1; g<=n; ++g){
+        if (plan.home_ok[g] && !numa->home[g].bound()) ++nc->bind_failed;
+        if (plan.sig_at[g] && plan.sig_at[g] == numa->sig[g].template as<V>() && !numa->sig[g].bound())
+          ++nc->bind_failed;
+        for(size_t nd=0; nd<plan.rep_ok[g].size(); ++nd)
+          if (plan.rep_ok[g][nd] && !numa->replicas[nd][g].bound()) ++nc->bind_failed;
+      }
+    }
+  }
+  return rep;
+}
 
-  // ====== 构造每方集合 ======
+// —— 合成集合：每方 S 个元素，其中 max(1, S/2) 个为全体共有 —— //
+static std::vector<std::vector<Block128>> make_synthetic_sets(int n, int S){
   std::vector<std::vector<Block128>> Xs(n+1);
   int common = std::max(1, S/2);
   std::vector<Block128> common_elems;
@@ -57,138 +642,477 @@ static double run_once(
       Xs[i].push_back(X(1000+i, 100000 + 1000*i + u));
     }
   }
+  return Xs;
+}
 
-  // ====== S12 ======
-  std::vector<std::vector<KV>> kv_all(n+1);
-  std::vector<std::vector<Tag128>> tag_all(n+1);
-
-  for(int i=1; i<=n; ++i){
-    Block128 alpha_i = hash_to_field_u64((u64)i);
-    kv_all[i].reserve(Xs[i].size());
-    tag_all[i].reserve(Xs[i].size());
+// —— 单次跑完整流程 —— //
+// Xs 下标 1..n（Xs[0] 不用），由调用方在计时区外准备。
+// pool 非空时走 DAG 调度（阶段重叠），否则按 S12→S13→S14→S31 屏障顺序执行。
+// stream_mem_bytes>0 启用流式 S14→S31：按桶分块放置/重构/释放，份额表峰值受该上限约束。
+// 各阶段的容器取自 ctx，同一形状的重复运行不再重新分配
+template <Field F, class T>
+static double run_once(
+    RunContextT<typename F::Elem, T>& ctx,
+    const std::vector<std::vector<Block128>>& Xs, int k,
+    double eps_okvs, uint32_t w, double eps_hash,
+    u64 salt_tag, int tag_bits,
+    Timings* t = nullptr,
+    Comm* comm = nullptr,  // *** COMM ***
+    RunCacheT<typename F::Elem, T>* cache = nullptr,
+    sched::Pool* pool = nullptr,
+    size_t stream_mem_bytes = 0,
+    NumaSetup* numa = nullptr,   // 非空则走 DAG 路径并按节点放置（pool 可为空）
+    NumaCounts* nc = nullptr,
+    DagPlan<typename F::Elem, T>* dag = nullptr   // DAG 路径复用的图；为空则本次临时构图
+){
+  using clk = std::chrono::high_resolution_clock;
+  using V = typename F::Elem;
+  auto g0 = clk::now();   // 开始
 
-    for(const auto& x : Xs[i]){
-      constexpr u64 poly_salt = 0xC0FFEEULL;   // 固定全局盐(只用于多项式系数)
-      PRG prg(mix_seed(x, poly_salt));         // 只依赖 x
-      Block128 fxi = poly_eval_fx_at_i(x, alpha_i, k, prg);
-      kv_all[i].push_back({x, fxi});
-      tag_all[i].push_back(tag_of(x, salt_tag));
-    }
-  }
-  auto g1 = clk::now();
+  const int n = (int)Xs.size() - 1;
+  if (numa && !pool) pool = numa->pool_ptrs.front();
 
-  // ====== S13: 各方编码 OKVS ======
-  std::vector<RBOKVS> okvs(n+1);
   std::vector<size_t> ni(n+1);
+  std::vector<OKVSParams> params(n+1);
+  size_t total_elems = 0;
   for(int i=1; i<=n; ++i){
     ni[i] = Xs[i].size();
+    params[i] = okvs_params_for(i, ni[i], eps_okvs, w);
+    total_elems += ni[i];
+  }
+
+  size_t M = 0;
+  for(int i=1;i<=n;++i) M = std::max(M, ni[i]);
+  size_t B = size_t(eps_hash * M) + 1;
 
-    OKVSParams p;
-    p.m = static_cast<size_t>(std::ceil((1.0 + eps_okvs) * ni[i]));
-    if (p.m < (size_t)w + 1) p.m = (size_t)w + 1;
-    p.w = w;
-    p.seed_r1 = 0xA1B2C3D400000000ULL ^ (uint64_t)i;
-    p.seed_r2 = 0x0F1E2D3C00000000ULL ^ ((uint64_t)i << 8);
+  // ====== 缓存：命中则跳过 S12/S13 ======
+  RunDigest key{};
+  std::shared_ptr<const EncodedPartiesT<V, T>> enc;
+  if (cache) {
+    key = run_digest(Xs, params, k, poly_salt, salt_tag, F::bits, tag_bits);
+    enc = cache->get(key, ni);
+  }
+  std::shared_ptr<EncodedPartiesT<V, T>> fresh;
+  if (!enc) fresh = ctx.take_encoded(n);
+  // 新产物在计时结束后才放入缓存：磁盘层同步写文件，不应计入冷启动的运行时间
+  const bool store = cache && fresh;
 
-    okvs[i] = RBOKVS::Encode(kv_all[i], p);
+  // 流式块大小：常驻部分按 S12/S13 产物（kv + tag + OKVS，与是否命中缓存无关）与分块索引估算
+  size_t chunk_buckets = 0;
+  if (stream_mem_bytes) {
+    size_t resident = 0;
+    for(int i=1; i<=n; ++i)
+      resident += ni[i] * (sizeof(KVT<V>) + sizeof(T)) + params[i].m * sizeof(V)
+                + ni[i] * (size_t)n * sizeof(uint32_t) + (B + 2) * sizeof(size_t);   // 分块索引的上界
+    size_t min_ceiling = 0;
+    chunk_buckets = stream_chunk_buckets<V, T>(stream_mem_bytes, resident, n, total_elems, B,
+                                         pool ? 2 : 1, &min_ceiling);
+    // 上限不可行：照常以单桶块运行，但明确告知（同一最小值只报一次，避免每次重复刷屏）
+    static size_t warned_min = 0;
+    if (min_ceiling && min_ceiling != warned_min) {
+      warned_min = min_ceiling;
+      std::cerr << "OTPSI_STREAM_MB=" << (stream_mem_bytes >> 20)
+                << " is below the minimum feasible ceiling of "
+                << ((min_ceiling + (1u << 20) - 1) >> 20) << " MB for n=" << n
+                << " (resident S12/S13 " << ((resident + (1u << 20) - 1) >> 20)
+                << " MB); running with 1-bucket chunks, memory will exceed the ceiling\n";
+    }
+  }
 
-    // *** COMM *** S13：每方上传 OKVS 表大小
+  // ====== 复用缓冲：份额表组数 / 每组桶数 / S31 区间数 ======
+  // DAG 流式：2 组在途块，每块切 sub 个 S31 区间；DAG 全量：1 组，S31 切 min(B, 4·线程数) 段
+  {
+    const size_t threads = numa ? numa->threads() : (pool ? pool->size() : 0);
+    const size_t s31_split = pool ? std::max<size_t>(1, threads * 4) : 1;
+    const bool multi_node = numa && numa->topo.multi();   // 桶数组留给绑核的 Place[i] 分配
+    if (chunk_buckets) {
+      const size_t nchunks = (B + chunk_buckets - 1) / chunk_buckets;
+      const size_t groups = pool ? std::min<size_t>(2, nchunks) : 1;
+      ctx.reset(n, chunk_buckets, groups, groups * std::min(chunk_buckets, s31_split), multi_node);
+    } else {
+      ctx.reset(n, B, 1, std::min(B, s31_split), multi_node);
+      // 多节点时 σ 暂存在 NumaSetup::sig（节点本地映射），不占 ctx.sig
+      if (pool && !multi_node) ctx.prepare_sig(ni);
+    }
+  }
+
+  if (pool) {
+    // ====== DAG 路径 ======
+    double stage_ms[4];
+    std::unique_ptr<DagPlan<V, T>> once;
+    if (!dag) { once = std::make_unique<DagPlan<V, T>>(); dag = once.get(); }
+    auto rep = run_dag<F, T>(*dag, *pool, n, k, salt_tag, tag_bits, B, Xs, params, fresh.get(), enc.get(),
+                       chunk_buckets, ctx, stage_ms, numa, nc);
+    if (fresh) enc = std::move(fresh);
     if (comm) {
-        uint64_t okvs_bytes = okvs[i].byte_size();
-      comm->S13 += okvs_bytes;
+      for(int i=1; i<=n; ++i){
+        comm->S13 += enc->okvs[i].byte_size();
+        comm->S14 += (uint64_t)ni[i] * (uint64_t)(n-1) * (sizeof(Block128) + sizeof(V));
+      }
     }
+    double total = std::chrono::duration<double,std::milli>(clk::now()-g0).count();
+    if (t) {
+      t->s12_ms=stage_ms[0]; t->s13_ms=stage_ms[1]; t->s14_ms=stage_ms[2]; t->s31_ms=stage_ms[3];
+      t->total_ms=total;
+      t->work_ms=rep.work_ms; t->crit_ms=rep.critical_ms;
+      t->crit_path.clear();
+      for(const auto& nm : rep.critical_path){
+        if (!t->crit_path.empty()) t->crit_path += '>';
+        t->crit_path += nm;
+      }
+    }
+    if (store) cache->put(key, enc);
+    return total;
+  }
+
+  auto g1 = clk::now();
+  if (fresh) {
+    // ====== S12 ======
+    for(int i=1; i<=n; ++i)
+      s12_party<F, T>(i, k, salt_tag, tag_bits, Xs[i], fresh->kv_all[i], fresh->tag_all[i]);
+    g1 = clk::now();
+
+    // ====== S13: 各方编码 OKVS ======
+    for(int i=1; i<=n; ++i)
+      RBOKVST<V>::EncodeInto(fresh->okvs[i], fresh->kv_all[i], params[i], ctx.enc_scratch[i]);
+
+    enc = std::move(fresh);
+  }
+
+  const auto& kv_all  = enc->kv_all;
+  const auto& tag_all = enc->tag_all;
+  const auto& okvs    = enc->okvs;
+
+  // *** COMM *** S13：每方上传 OKVS 表大小（命中缓存时仍计入，协议流量不变）
+  if (comm) {
+    for(int i=1; i<=n; ++i) comm->S13 += okvs[i].byte_size();
   }
   auto g2 = clk::now();
 
-  // ====== S14 ======
-  size_t M = 0; 
-  for(int i=1;i<=n;++i) M = std::max(M, ni[i]);
-  size_t B = size_t(eps_hash * M) + 1;
+  double s14 = 0, s31 = 0;
+  if (chunk_buckets) {
+    // ====== 流式 S14→S31：逐块放置、重构、释放 ======
+    auto& Tc  = ctx.tables[0].Ts;
+    auto& pos = ctx.tables[0].pos;
+    {
+      auto b0 = clk::now();
+      for(int i=1; i<=n; ++i)
+        build_chunk_index(ctx.chunk_idx[i], kv_all[i], n, salt_tag, B, chunk_buckets, pos[i]);
+      s14 += std::chrono::duration<double,std::milli>(clk::now()-b0).count();
+    }
+    for(size_t lo=0, c=0; lo<B; lo+=chunk_buckets, ++c){
+      const size_t hi = std::min(B, lo + chunk_buckets);
+      auto c0 = clk::now();
+      for(int i=1; i<=n; ++i)
+        s14_place_range(*enc, n, i, B, salt_tag, ctx.chunk_idx[i], c, lo, hi, Tc[i], pos[i],
+                        [&](int g){ return okvs[g].S.data(); });
+      auto c1 = clk::now();
+      s31_range<F, T>(Tc, n, k, salt_tag, tag_bits, lo, hi, lo, ctx.s31[0]);
+      RunContextT<V, T>::clear_tables(Tc);
+      auto c2 = clk::now();
+      s14 += std::chrono::duration<double,std::milli>(c1-c0).count();
+      s31 += std::chrono::duration<double,std::milli>(c2-c1).count();
+    }
+    auto c3 = clk::now();
+    ctx.collect_result();
+    s31 += std::chrono::duration<double,std::milli>(clk::now()-c3).count();
+    // *** COMM *** 与全量模式相同：每个 (x, g≠i) 各一次查询与应答
+    if (comm) {
+      for(int i=1; i<=n; ++i) comm->S14 += (uint64_t)ni[i] * (uint64_t)(n-1) * (sizeof(Block128) + sizeof(V));
+    }
+  } else {
+    auto& Ts     = ctx.tables[0].Ts;
+    auto& pos    = ctx.tables[0].pos;
 
-  std::vector<HashTableTi> Ts(n+1, HashTableTi{std::vector<Bucket>(B)});
+    // ====== S14 ======
+    for(int i=1;i<=n;++i){
+      for(size_t j=0;j<ni[i];++j){
+        const Block128& x   = kv_all[i][j].key;
+        const V& fxi = kv_all[i][j].val;
 
-  for(int i=1;i<=n;++i){
-    for(size_t j=0;j<ni[i];++j){
-      const Block128& x   = kv_all[i][j].key;
-      const Block128& fxi = kv_all[i][j].val;
+        auto& sigmas = ctx.sigmas[i];
+        sigmas.clear();
 
-      std::vector<std::pair<int, Block128>> sigmas;
-      sigmas.reserve(n-1);
+        for(int g=1; g<=n; ++g){
+          if(g==i) continue;
 
-      for(int g=1; g<=n; ++g){
-        if(g==i) continue;
+          // *** COMM *** i → g 发送 x（16 字节）
+          if (comm) comm->S14 += sizeof(Block128);
 
-        // *** COMM *** i → g 发送 x（16 字节）
-        if (comm) comm->S14 += sizeof(Block128);
+          V sig = okvs[g].Decode(x);
 
-        Block128 sig = okvs[g].Decode(x);
+          // *** COMM *** g → i 发送 σ（域元素宽度）
+          if (comm) comm->S14 += sizeof(V);
 
-        // *** COMM *** g → i 发送 σ（16 字节）
-        if (comm) comm->S14 += sizeof(Block128);
+          sigmas.emplace_back(g, sig);
+        }
 
-        sigmas.emplace_back(g, sig);
+        insert_element_Ti(Ts[i], B, n, i, x, tag_all[i][j], fxi, sigmas, salt_tag, pos[i]);
       }
-
-      insert_element_Ti(Ts[i], B, n, i, x, tag_all[i][j], fxi, sigmas, salt_tag);
     }
+    auto g3 = clk::now();
+
+    // ====== S31–S33（无通信，不统计） ======
+    const int agg = n; (void)agg;
+    s31_range<F, T>(Ts, n, k, salt_tag, tag_bits, 0, B, 0, ctx.s31[0]);
+    ctx.collect_result();
+    s14 = std::chrono::duration<double,std::milli>(g3-g2).count();
+    s31 = std::chrono::duration<double,std::milli>(clk::now()-g3).count();
   }
-  auto g3 = clk::now();
+  auto g4 = clk::now();
+
+  // ====== 写阶段耗时 ======
+  double s12 = std::chrono::duration<double,std::milli>(g1-g0).count();
+  double s13 = std::chrono::duration<double,std::milli>(g2-g1).count();
+  double total = std::chrono::duration<double,std::milli>(g4-g0).count();
+  if (t) {
+    t->s12_ms=s12; t->s13_ms=s13; t->s14_ms=s14; t->s31_ms=s31; t->total_ms=total;
+    t->work_ms=total; t->crit_ms=total; t->crit_path = "S12>S13>S14>S31";
+  }
+
+  if (store) cache->put(key, enc);
+  return total;
+}
+
+
+// —— 多进程模拟：每方一个子进程，经共享内存交换 —— //
+// 共享区均由父进程在 fork 前创建（OKVS 表只由其所有方解码应答，留在各自进程内，不进共享区）：
+//   控制区：abort 标志 + 每方门铃 + 每方阶段耗时 + (n+1)² 条链路统计
+//   环区：每条有向链路 src→dst 一个 SPSC 环，承载 src 的查询批次与 src 对 dst 查询的应答
+//   CSR 区：第 i 方 S14 放置完成后写出 offsets[B+1] + shares[|X_i|·n]，父进程（聚合方）就地做 S31
+// 每方每条链路最多 kWindow 个未应答批次：环容量按 kWindow 个查询 + kWindow 个应答预留，
+// 因而应答总能写入，双方互相等待时也不会死锁。
+struct MpPartyStat {
+  double s12_ms, s13_ms, s14_ms, place_ms;
+  uint64_t okvs_bytes;
+};
 
-  // ====== S31–S33（无通信，不统计） ======
-  const int agg = n; (void)agg;
-  std::set<u64> result_hash;
-  auto tag_key = [](const Tag128& t)->u64 { return t.hi ^ (t.lo<<1); };
+template <Field F, class T>
+static double run_multiproc(
+    RunContextT<typename F::Elem, T>& ctx,
+    const std::vector<std::vector<Block128>>& Xs, int k,
+    double eps_okvs, uint32_t w, double eps_hash,
+    u64 salt_tag, int tag_bits, size_t batch,
+    Timings* t, Comm* comm, std::vector<LinkStat>* links
+){
+  using clk = std::chrono::high_resolution_clock;
+  using V  = typename F::Elem;
+  using Sh = ShareT<V, T>;
+  enum : uint32_t { kQuery = 1, kAnswer = 2 };
+  constexpr size_t kWindow = 2;
 
-  for(size_t eta=0; eta<B; ++eta){
-    std::vector<Share> pool; pool.reserve(8);
-    for(int i=1;i<=n;++i)
-      for(const auto &sh : Ts[i].table[eta].items) pool.push_back(sh);
+  const int n = (int)Xs.size() - 1;
+  const size_t L = (size_t)(n+1);
+  std::vector<size_t> ni(n+1);
+  std::vector<OKVSParams> params(n+1);
+  size_t M = 0;
+  for(int i=1; i<=n; ++i){
+    ni[i] = Xs[i].size();
+    params[i] = okvs_params_for(i, ni[i], eps_okvs, w);
+    M = std::max(M, ni[i]);
+  }
+  const size_t B = size_t(eps_hash * M) + 1;
+  batch = std::max<size_t>(1, std::min(batch, M));
 
-    std::unordered_map<u64, std::vector<Share>> by_tag;
-    for(const auto &sh: pool) by_tag[tag_key(sh.tag)].push_back(sh);
+  // ====== 共享区 ======
+  auto up64 = [](size_t x){ return (x + 63) & ~size_t(63); };
+  const size_t off_bells = up64(sizeof(std::atomic<uint32_t>));
+  const size_t off_stats = off_bells + up64(L * sizeof(shm::Doorbell));
+  const size_t off_links = off_stats + up64(L * sizeof(MpPartyStat));
+  shm::Region ctrl("otpsi-ctrl", off_links + L * L * sizeof(LinkStat));
 
-    for(auto& kv : by_tag){
-      auto &vec = kv.second;
+  const size_t cap  = up64(shm::Ring::capacity_for(batch * sizeof(Block128), 2 * kWindow));
+  const size_t slot = up64(sizeof(shm::RingHdr)) + cap;
+  shm::Region rings("otpsi-rings", L * L * slot);
 
-      std::vector<std::pair<Block128,Block128>> pts;
-      std::unordered_set<int> seen_party;
-      pts.reserve(vec.size());
+  std::vector<shm::Region> csr_reg(n+1);
+  const size_t csr_shares_off = up64((B + 1) * sizeof(uint64_t));
+  bool ok = ctrl.ok() && rings.ok();
+  for(int i=1; i<=n && ok; ++i){
+    csr_reg[i] = shm::Region("otpsi-csr", csr_shares_off + ni[i] * (size_t)n * sizeof(Sh));
+    ok = csr_reg[i].ok();
+  }
+  if (!ok) { std::cerr << "multiproc: shared memory setup failed\n"; return -1; }
 
-      for(const auto &sh : vec){
-        if(seen_party.insert(sh.party_id).second){
-          pts.push_back({ gf128::from_u64((u64)sh.party_id), sh.fx_i });
-        }
+  auto* abort_flag = ctrl.as<std::atomic<uint32_t>>(0);
+  auto* bells = ctrl.as<shm::Doorbell>(off_bells);
+  auto* stats = ctrl.as<MpPartyStat>(off_stats);
+  auto* lst   = ctrl.as<LinkStat>(off_links);
+  new (abort_flag) std::atomic<uint32_t>(0);
+  for(size_t i=0; i<L; ++i) new (&bells[i]) shm::Doorbell();
+  auto ring_of = [&](int src, int dst){
+    uint8_t* base = rings.as<uint8_t>(((size_t)src * L + (size_t)dst) * slot);
+    return shm::Ring(reinterpret_cast<shm::RingHdr*>(base), base + up64(sizeof(shm::RingHdr)));
+  };
+  for(int a=1; a<=n; ++a)
+    for(int b=1; b<=n; ++b)
+      if (a != b) {
+        auto* h = new (rings.as<uint8_t>(((size_t)a * L + (size_t)b) * slot)) shm::RingHdr();
+        shm::Ring::init(h, cap);
       }
-      if((int)pts.size() < k) continue;
 
-      std::vector<std::pair<Block128,Block128>> use_pts(pts.begin(), pts.begin()+k);
+  auto g0 = clk::now();
 
-      Block128 s_rec = gf128::lagrange_at_gf128(use_pts, gf128::zero());
+  // ====== 第 i 方（子进程） ======
+  auto party = [&](int i) -> int {
+    using ms = std::chrono::duration<double, std::milli>;
+    auto p0 = clk::now();
+    std::vector<KVT<V>> kv;
+    std::vector<T> tags;
+    s12_party<F, T>(i, k, salt_tag, tag_bits, Xs[i], kv, tags);
+    auto p1 = clk::now();
 
-      bool ok = true;
-      for(const auto &pr : use_pts){
-        Block128 check = gf128::lagrange_at_gf128(use_pts, pr.first);
-        if ((check.hi ^ pr.second.hi) | (check.lo ^ pr.second.lo)){ ok = false; break; }
+    // S13：表留在本进程，S14 中由本方在其上解码应答对方的查询
+    const auto enc = RBOKVST<V>::Encode(kv, params[i]);
+    if (enc.S.size() != params[i].m) return 3;
+    const V* my_S = enc.S.data();
+    auto p2 = clk::now();
+
+    // S14：向每个对方分批发送查询，同时应答对方的查询
+    std::vector<V> sig(ni[i] * L);
+    std::vector<size_t> next(n+1, 0), outstanding(n+1, 0), got(n+1, 0), served(n+1, 0);
+    auto done = [&]{
+      for(int g=1; g<=n; ++g)
+        if (g != i && (got[g] < ni[i] || served[g] < ni[g])) return false;
+      return true;
+    };
+    while (!done()) {
+      const uint32_t seen = bells[i].seq.load(std::memory_order_seq_cst);
+      bool progressed = false;
+      for(int g=1; g<=n; ++g){
+        if (g == i) continue;
+        shm::Ring in = ring_of(g, i), out = ring_of(i, g);
+        while (const shm::MsgHdr* m = in.peek()) {
+          const uint64_t now = shm::now_ns();
+          const uint8_t* payload = reinterpret_cast<const uint8_t*>(m) + sizeof(shm::MsgHdr);
+          if (m->type == kQuery) {
+            const auto* xs = reinterpret_cast<const Block128*>(payload);
+            shm::MsgHdr a{}; a.type = kAnswer; a.count = m->count; a.seq = m->seq;
+            a.echo_ns = m->send_ns;   // send_ns 由 try_push 在解码完成后填写
+            const bool pushed = out.try_push(a, m->count * sizeof(V), [&](uint8_t* dst){
+              V* vs = reinterpret_cast<V*>(dst);
+              for(uint32_t q=0; q<m->count; ++q) vs[q] = RBOKVST<V>::DecodeAt(params[i], my_S, xs[q]);
+            });
+            if (!pushed) break;               // 窗口约束下不应发生；留在环中下轮重试
+            served[g] += m->count;
+            shm::ring(bells[g]);
+          } else if (m->type == kAnswer) {
+            const auto* vs = reinterpret_cast<const V*>(payload);
+            for(uint32_t q=0; q<m->count; ++q) sig[(m->seq + q) * L + g] = vs[q];
+            got[g] += m->count;
+            --outstanding[g];
+            LinkStat& rt = lst[(size_t)i * L + g];
+            rt.rtt_sum_ns += now - m->echo_ns; ++rt.rtt_n;
+          }
+          LinkStat& ls = lst[(size_t)g * L + i];   // g→i 由接收方 i 记录
+          ls.bytes += m->count * (m->type == kQuery ? sizeof(Block128) : sizeof(V));
+          ++ls.msgs;
+          ls.lat_sum_ns += now - m->send_ns;
+          ls.lat_max_ns = std::max<uint64_t>(ls.lat_max_ns, now - m->send_ns);
+          in.pop(m);
+          progressed = true;
+        }
+        while (outstanding[g] < kWindow && next[g] < ni[i]) {
+          const size_t j0 = next[g], cnt = std::min(batch, ni[i] - j0);
+          shm::MsgHdr q{}; q.type = kQuery; q.count = (uint32_t)cnt; q.seq = j0;
+          const bool pushed = out.try_push(q, cnt * sizeof(Block128), [&](uint8_t* dst){
+            auto* xs = reinterpret_cast<Block128*>(dst);
+            for(size_t q2=0; q2<cnt; ++q2) xs[q2] = kv[j0 + q2].key;
+          });
+          if (!pushed) break;
+          next[g] += cnt; ++outstanding[g];
+          shm::ring(bells[g]);
+          progressed = true;
+        }
       }
+      if (!progressed) {
+        if (abort_flag->load()) return 2;
+        shm::wait(bells[i], seen, 50);
+      }
+    }
+    auto p3 = clk::now();
 
-      if(ok) result_hash.insert(kv.first);
+    // 放置到本地份额表，再按桶写成 CSR 供聚合方读取
+    HashTableTiT<V, T> Ti{std::vector<BucketT<V, T>>(B)};
+    std::vector<std::pair<int, V>> sigmas;
+    std::vector<size_t> pos;
+    for(size_t j=0; j<ni[i]; ++j){
+      sigmas.clear();
+      for(int g=1; g<=n; ++g) if (g != i) sigmas.emplace_back(g, sig[j * L + g]);
+      insert_element_Ti(Ti, B, n, i, kv[j].key, tags[j], kv[j].val, sigmas, salt_tag, pos);
     }
+    auto* off = csr_reg[i].as<uint64_t>();
+    auto* sh  = csr_reg[i].as<Sh>(csr_shares_off);
+    off[0] = 0;
+    for(size_t b=0; b<B; ++b){
+      const auto& items = Ti.table[b].items;
+      std::copy(items.begin(), items.end(), sh + off[b]);
+      off[b+1] = off[b] + items.size();
+    }
+    auto p4 = clk::now();
+
+    stats[i] = MpPartyStat{ ms(p1-p0).count(), ms(p2-p1).count(), ms(p3-p2).count(),
+                            ms(p4-p3).count(), params[i].m * sizeof(V) };
+    return 0;
+  };
+
+  // ====== fork / 回收 ======
+  std::vector<pid_t> pids;
+  bool failed = false;
+  for(int i=1; i<=n; ++i){
+    pid_t pid = ::fork();
+    if (pid == 0) ::_exit(party(i));   // 子进程不返回调用栈，避免析构父进程状态
+    if (pid < 0) { failed = true; break; }
+    pids.push_back(pid);
   }
+  if (failed) { abort_flag->store(1); for(size_t i=0; i<L; ++i) shm::ring(bells[i]); }
+  for(size_t r=0; r<pids.size(); ++r){
+    int st = 0;
+    if (::waitpid(-1, &st, 0) < 0 || !WIFEXITED(st) || WEXITSTATUS(st) != 0) {
+      failed = true;
+      abort_flag->store(1);
+      for(size_t i=0; i<L; ++i) shm::ring(bells[i]);
+    }
+  }
+  if (failed) { std::cerr << "multiproc: a party process failed\n"; return -1; }
+  auto g3 = clk::now();
+
+  // ====== S31：聚合方直接读各方 CSR ======
+  ctx.reset(n, 0, 0, 1);
+  s31_range_by<F, T>([&](int i, size_t eta){
+    const auto* off = csr_reg[i].as<uint64_t>();
+    return std::make_pair(csr_reg[i].as<Sh>(csr_shares_off) + off[eta], (size_t)(off[eta+1] - off[eta]));
+  }, n, k, salt_tag, tag_bits, 0, B, ctx.s31[0]);
+  ctx.collect_result();
   auto g4 = clk::now();
 
-  // ====== 写阶段耗时 ======
-  double s12 = std::chrono::duration<double,std::milli>(g1-g0).count();
-  double s13 = std::chrono::duration<double,std::milli>(g2-g1).count();
-  double s14 = std::chrono::duration<double,std::milli>(g3-g2).count();
-  double s31 = std::chrono::duration<double,std::milli>(g4-g3).count();
+  // ====== 汇总：各方并行，阶段耗时取最慢一方 ======
   double total = std::chrono::duration<double,std::milli>(g4-g0).count();
-  if (t) { t->s12_ms=s12; t->s13_ms=s13; t->s14_ms=s14; t->s31_ms=s31; t->total_ms=total; }
-
+  double s31 = std::chrono::duration<double,std::milli>(g4-g3).count();
+  if (t) {
+    *t = Timings{};
+    for(int i=1; i<=n; ++i){
+      t->s12_ms = std::max(t->s12_ms, stats[i].s12_ms);
+      t->s13_ms = std::max(t->s13_ms, stats[i].s13_ms);
+      t->s14_ms = std::max(t->s14_ms, stats[i].s14_ms + stats[i].place_ms);
+      t->work_ms += stats[i].s12_ms + stats[i].s13_ms + stats[i].s14_ms + stats[i].place_ms;
+    }
+    t->s31_ms = s31; t->total_ms = total;
+    t->work_ms += s31; t->crit_ms = total; t->crit_path = "S12>S13>S14>S31";
+  }
+  if (comm) {
+    for(int i=1; i<=n; ++i) comm->S13 += stats[i].okvs_bytes;
+    for(size_t e=0; e<L*L; ++e) comm->S14 += lst[e].bytes;
+  }
+  if (links) links->assign(lst, lst + L*L);
   return total;
 }
 
 
-int main(){
+template <Field F, class T>
+static int bench_main(int tag_bits){
+    using V = typename F::Elem;
+
     // ====== 协议固定参数 ======
     const double eps_okvs = 0.05;
     const uint32_t w = 192;
@@ -201,6 +1125,109 @@ int main(){
     std::vector<int> t_values = {2, 3, 5, 7};
     const int reps = 5;
 
+    // ====== 可选：S12/S13 产物缓存 ======
+    // OTPSI_CACHE_MB=<内存层上限 MB> 启用；OTPSI_CACHE_DIR=<目录> 另开磁盘层
+    std::unique_ptr<RunCacheT<V, T>> cache;
+    {
+        const char* mb  = std::getenv("OTPSI_CACHE_MB");
+        const char* dir = std::getenv("OTPSI_CACHE_DIR");
+        if ((mb && std::atoll(mb) > 0) || (dir && *dir)) {
+            size_t bytes = mb ? (size_t)std::atoll(mb) << 20 : 0;
+            cache = std::make_unique<RunCacheT<V, T>>(bytes, dir ? dir : "");
+        }
+    }
+
+    // ====== 可选：多进程模拟 ======
+    // OTPSI_MP=1：每方 fork 一个进程，经共享内存环交换 S14 查询；OTPSI_MP_BATCH=<每批查询数>（缺省 1024）
+    // 此模式下 COMM 为实测载荷字节，另写 links_m_t_n.csv（每条有向链路的字节数与时延）。
+    // 须在创建任何线程池之前判定：多线程进程里 fork 只复制调用线程，故此模式忽略 DAG/NUMA 设置
+    const char* mp_env = std::getenv("OTPSI_MP");
+    const bool multiproc = mp_env && std::atoi(mp_env) != 0;
+    size_t mp_batch = 1024;
+    if (const char* mb = std::getenv("OTPSI_MP_BATCH")) mp_batch = (size_t)std::max(1LL, std::atoll(mb));
+
+    if (multiproc && (std::getenv("OTPSI_SCHED") || std::getenv("OTPSI_NUMA")))
+        std::cerr << "OTPSI_MP=1: ignoring OTPSI_SCHED/OTPSI_NUMA (no thread pools before fork)\n";
+
+    // ====== 可选：DAG 调度（阶段重叠） ======
+    // OTPSI_SCHED=dag 启用；OTPSI_THREADS=<线程数>，缺省为硬件并发数
+    std::unique_ptr<sched::Pool> pool;
+    const char* numa_env = std::getenv("OTPSI_NUMA");
+    const bool numa_on = !multiproc && numa_env && std::atoi(numa_env) != 0;
+    {
+        const char* sc = std::getenv("OTPSI_SCHED");
+        if (sc && std::string(sc) == "dag" && !numa_on && !multiproc) {
+            const char* th = std::getenv("OTPSI_THREADS");
+            pool = std::make_unique<sched::Pool>(th ? (unsigned)std::atoi(th) : 0u);
+        }
+    }
+
+    // ====== 可选：NUMA 感知（隐含 DAG 调度） ======
+    // OTPSI_NUMA=1：每节点一个绑核线程池；各方的 OKVS 拷贝与 σ 暂存放在其节点的 NodeBuffer 上，
+    // 份额表由绑核线程首次触碰（堆内存，不做 mbind）。
+    // OTPSI_THREADS 为总线程数（按节点均分，缺省每节点取其 CPU 数）；
+    // OTPSI_NUMA_PAGES=thp|hugetlb 选择上述 NodeBuffer 与副本的页类型（份额表不受影响）；OTPSI_NUMA_REPLICA_MB 为副本预算（缺省 256）。
+    // 单节点时退化为普通 DAG（不复制、不绑内存），访问计数全部为本地
+    std::unique_ptr<NumaSetup> numa;
+    if (numa_on) {
+        numa = std::make_unique<NumaSetup>();
+        numa->topo = numa::detect();
+        const int nodes = numa->topo.nodes();
+        const char* th = std::getenv("OTPSI_THREADS");
+        const unsigned total = th ? (unsigned)std::atoi(th) : 0u;
+        for (int nd = 0; nd < nodes; ++nd) {
+            const std::vector<int>& cpus = numa->topo.cpus[nd];
+            const unsigned per = total ? std::max(1u, total / (unsigned)nodes) : (unsigned)cpus.size();
+            numa->pools.push_back(std::make_unique<sched::Pool>(per, [&cpus](unsigned){
+                numa::pin_current_thread(cpus);
+            }));
+            numa->pool_ptrs.push_back(numa->pools.back().get());
+        }
+        if (const char* pg = std::getenv("OTPSI_NUMA_PAGES")) {
+            if (std::string(pg) == "thp")     numa->pages = numa::Pages::THP;
+            if (std::string(pg) == "hugetlb") numa->pages = numa::Pages::HugeTLB;
+        }
+        const char* rb = std::getenv("OTPSI_NUMA_REPLICA_MB");
+        numa->replica_budget = (size_t)(rb ? std::atoll(rb) : 256) << 20;
+        std::cout << "[numa] nodes=" << nodes << " threads=" << numa->threads()
+                  << (numa->topo.multi() ? "" : " (single node: placement disabled)") << "\n";
+    }
+
+    // ====== 可选：流式 S14→S31 ======
+    // OTPSI_STREAM_MB=<内存上限 MB>：按桶分块处理，份额表不再整体驻留
+    size_t stream_mem_bytes = 0;
+    if (const char* sm = std::getenv("OTPSI_STREAM_MB")) stream_mem_bytes = (size_t)std::atoll(sm) << 20;
+
+    // ====== 可选：从集合文件读取输入 ======
+    // OTPSI_SET_DIR=<目录>：读取 party_1..n.oset（gen_sets 生成），n 取文件数，m 取最大集合大小
+    std::vector<std::vector<Block128>> file_sets;
+    if (const char* sd = std::getenv("OTPSI_SET_DIR")) {
+        auto l0 = std::chrono::high_resolution_clock::now();
+        file_sets = load_set_dir(sd);
+        double load_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - l0).count();
+        if (file_sets.size() < 2) {
+            std::cerr << "OTPSI_SET_DIR: no readable party_<i>.oset in " << sd << "\n";
+            return 1;
+        }
+        size_t total = 0, mx = 0;
+        for (size_t i = 1; i < file_sets.size(); ++i) {
+            total += file_sets[i].size();
+            mx = std::max(mx, file_sets[i].size());
+        }
+        const int nf = (int)file_sets.size() - 1;
+        std::cout << "[sets] dir=" << sd << " n=" << nf << " total=" << total
+                  << " max=" << mx << " load_ms=" << load_ms << "\n";
+        m_values = { (int)mx };
+        n_values = { nf };
+        t_values.erase(std::remove_if(t_values.begin(), t_values.end(),
+                                      [&](int t){ return t > nf; }), t_values.end());
+    }
+
+    // 跨重复运行复用的缓冲区（每次 run_once 开头 reset，不释放）与 DAG（同形状时重跑同一张图）
+    RunContextT<V, T> ctx;
+    DagPlan<V, T> dag;
+
     // 百分位函数
     auto percentile = [](std::vector<double> v, double p){
         size_t N = v.size();
@@ -217,11 +1244,37 @@ int main(){
     std::ofstream out_comm("comm_m_t_n.csv", std::ios::out | std::ios::trunc);
     out_comm << "m_fixed,t_eff,n,S13_bytes,S14_bytes,total_bytes\n";
 
+    std::ofstream out_links;
+    if (multiproc) {
+        out_links.open("links_m_t_n.csv", std::ios::out | std::ios::trunc);
+        out_links << "m_fixed,t_eff,n,rep,src,dst,bytes,msgs,lat_mean_us,lat_max_us,rtt_mean_us\n";
+    }
+
+    // DAG 模式：逐次运行的关键路径
+    std::ofstream out_dag;
+    if (pool || numa) {
+        out_dag.open("dag_m_t_n.csv", std::ios::out | std::ios::trunc);
+        out_dag << "m_fixed,t_eff,n,rep,wall_ms,work_ms,critical_ms,critical_path\n";
+    }
+
+    // NUMA 模式：逐次运行的本地/跨节点访问计数
+    std::ofstream out_numa;
+    if (numa) {
+        out_numa.open("numa_m_t_n.csv", std::ios::out | std::ios::trunc);
+        out_numa << "m_fixed,t_eff,n,rep,nodes,replicated,s14_local,s14_remote,s31_local,s31_remote,bind_failed\n";
+    }
+
     // ====== 主循环 ======
     for(int m : m_values){
         for(int t : t_values){
             for(int n : n_values){
 
+                // 集合在计时区外准备：文件输入直接复用，否则按 (n, m) 合成
+                std::vector<std::vector<Block128>> synth;
+                if (file_sets.empty()) synth = make_synthetic_sets(n, m);
+                const auto& Xs = file_sets.empty() ? synth : file_sets;
+
+                NumaCounts nuc_sum;
                 std::vector<double> v;
                 std::vector<uint64_t> S13s, S14s, Totals;
                 v.reserve(reps);
@@ -231,9 +1284,44 @@ int main(){
 
                 for(int r=0; r<reps; ++r){
                     Comm comm;   // *** COMM ***
-                    double ms =
-                        run_once(n, m, t, eps_okvs, w, eps_hash, salt_tag,
-                                 nullptr, &comm);
+                    NumaCounts nuc;
+                    Timings tm;
+                    double ms;
+                    if (multiproc) {
+                        std::vector<LinkStat> ls;
+                        ms = run_multiproc<F, T>(ctx, Xs, t, eps_okvs, w, eps_hash, salt_tag, tag_bits,
+                                                 mp_batch, &tm, &comm, &ls);
+                        if (ms < 0) return 1;
+                        const size_t L = Xs.size();
+                        for(size_t a=1; a<L; ++a)
+                            for(size_t b=1; b<L; ++b){
+                                const LinkStat& e = ls[a*L + b];
+                                if (a == b || !e.msgs) continue;
+                                out_links << m << "," << t << "," << n << "," << r << ","
+                                          << a << "," << b << "," << e.bytes << "," << e.msgs << ","
+                                          << e.lat_sum_ns / 1e3 / e.msgs << "," << e.lat_max_ns / 1e3 << ","
+                                          << (e.rtt_n ? e.rtt_sum_ns / 1e3 / e.rtt_n : 0.0) << "\n";
+                            }
+                    } else {
+                        ms = run_once<F, T>(ctx, Xs, t, eps_okvs, w, eps_hash, salt_tag, tag_bits,
+                                            &tm, &comm, cache.get(), pool.get(),
+                                            stream_mem_bytes, numa.get(), &nuc, &dag);
+                    }
+
+                    if (numa) {
+                        out_numa << m << "," << t << "," << n << "," << r << ","
+                                 << numa->topo.nodes() << "," << nuc.replicated << ","
+                                 << nuc.s14_local << "," << nuc.s14_remote << ","
+                                 << nuc.s31_local << "," << nuc.s31_remote << "," << nuc.bind_failed << "\n";
+                        nuc_sum.s14_local += nuc.s14_local; nuc_sum.s14_remote += nuc.s14_remote;
+                        nuc_sum.s31_local += nuc.s31_local; nuc_sum.s31_remote += nuc.s31_remote;
+                        nuc_sum.bind_failed += nuc.bind_failed;
+                    }
+                    if (pool || numa) {
+                        out_dag << m << "," << t << "," << n << "," << r << ","
+                                << tm.total_ms << "," << tm.work_ms << ","
+                                << tm.crit_ms << "," << tm.crit_path << "\n";
+                    }
 
                     v.push_back(ms / 1000.0);
                     S13s.push_back(comm.S13);
@@ -275,11 +1363,62 @@ int main(){
           << " p97.5="<<p97<<" s"
           << "\n";
 
+                // 标签误匹配上界（联合界，见 tag_false_match_log2）
+                const size_t B_cfg = size_t(eps_hash * m) + 1;
+                const double lg = tag_false_match_log2(tag_bits, n, (size_t)n * m, B_cfg);
+                std::cout << "[m="<<m<<", t="<<t<<", n="<<n
+                          << "] TAG bits="<<tag_bits<<" log2 P_false<="<<lg
+                          << (lg > -40 ? "  (warning: exceeds 2^-40 target)" : "") << "\n";
+
+                if (numa) {
+                    auto ratio = [](uint64_t a, uint64_t b){ return a + b ? 100.0 * a / (double)(a + b) : 100.0; };
+                    std::cout << "[m="<<m<<", t="<<t<<", n="<<n
+                              << "] NUMA nodes="<<numa->topo.nodes()
+                              << " S14 local="<<ratio(nuc_sum.s14_local, nuc_sum.s14_remote)<<"%"
+                              << " S31 local="<<ratio(nuc_sum.s31_local, nuc_sum.s31_remote)<<"%"
+                              << (nuc_sum.bind_failed ? " (mbind failed on " + std::to_string(nuc_sum.bind_failed)
+                                                        + " buffers)" : std::string()) << "\n";
+                }
+
             }
         }
     }
 
+    if (cache) {
+        auto cs = cache->stats();
+        std::cout << "[cache] hits=" << cs.hits << " disk_hits=" << cs.disk_hits
+                  << " misses=" << cs.misses << " evictions=" << cs.evictions
+                  << " bytes=" << cs.bytes << "\n";
+    }
+
     std::cout << "✅ Wrote rt_m_t_n.csv and comm_m_t_n.csv\n";
     return 0;
 }
 
+// OTPSI_TAG_BITS=32|64|128 选择标签宽度（缺省 128），误匹配上界见 tag_false_match_log2；
+// 其他取值直接报错退出，不静默回退到 128
+template <Field F>
+static int bench_tag_dispatch(){
+    const char* tb = std::getenv("OTPSI_TAG_BITS");
+    switch (tb ? std::atoi(tb) : 128) {
+        case 32:  return bench_main<F, u32>(32);
+        case 64:  return bench_main<F, u64>(64);
+        case 128: return bench_main<F, Tag128>(128);
+        default:
+            std::cerr << "OTPSI_TAG_BITS=" << tb << " is not supported (use 32, 64 or 128)\n";
+            return 2;
+    }
+}
+
+int main(){
+    // OTPSI_FIELD=64 选用 GF(2^64)（值/OKVS/S14 应答减半）；缺省 GF(2^128)
+    const char* fb = std::getenv("OTPSI_FIELD");
+    const bool use64 = fb && std::atoi(fb) == 64;
+    // 运算有误时 S31 结果无意义：先验证域公理
+    if (use64 ? !field_self_check<GF64>() : !field_self_check<GF128>()) {
+        std::cerr << "field self-check failed for " << (use64 ? GF64::name : GF128::name) << "\n";
+        return 1;
+    }
+    if (use64) return bench_tag_dispatch<GF64>();
+    return bench_tag_dispatch<GF128>();
+}
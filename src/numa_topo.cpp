@@ -0,0 +1,159 @@
+#include "numa_topo.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace numa {
+
+// ============ 拓扑 ============
+std::vector<int> parse_cpulist(const std::string& s) {
+  std::vector<int> out;
+  size_t i = 0;
+  while (i < s.size()) {
+    char* end = nullptr;
+    long a = std::strtol(s.c_str() + i, &end, 10);
+    if (end == s.c_str() + i) break;
+    i = (size_t)(end - s.c_str());
+    long b = a;
+    if (i < s.size() && s[i] == '-') {
+      b = std::strtol(s.c_str() + i + 1, &end, 10);
+      i = (size_t)(end - s.c_str());
+    }
+    for (long c = a; c <= b; ++c) out.push_back((int)c);
+    while (i < s.size() && (s[i] == ',' || s[i] == '\n' || s[i] == ' ')) ++i;
+  }
+  return out;
+}
+
+Topology detect() {
+  Topology t;
+  // 节点编号可能不连续（如只有 node0、node2）：逐个探测，跳过空节点
+  for (int nd = 0; nd < 1024; ++nd) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(nd) + "/cpulist");
+    if (!in) {
+      if (nd > 64 && !t.cpus.empty()) break;
+      continue;
+    }
+    std::string line;
+    std::getline(in, line);
+    auto cpus = parse_cpulist(line);
+    if (cpus.empty()) continue;
+    t.cpus.push_back(std::move(cpus));
+    t.ids.push_back(nd);
+  }
+  if (t.cpus.empty()) {
+    std::vector<int> all(std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t c = 0; c < all.size(); ++c) all[c] = (int)c;
+    t.cpus.push_back(std::move(all));
+    t.ids.push_back(0);
+  }
+  return t;
+}
+
+bool pin_current_thread(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : cpus) if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+// ============ 放置 ============
+bool bind(const void* p, size_t len, int node, bool move) {
+  if (!p || len == 0 || node < 0 || node >= 64) return false;
+  const uintptr_t page = (uintptr_t)::sysconf(_SC_PAGESIZE);
+  const uintptr_t lo = ((uintptr_t)p + page - 1) & ~(page - 1);
+  const uintptr_t hi = ((uintptr_t)p + len) & ~(page - 1);
+  if (hi <= lo) return false;   // 不足一整页：保持原样
+  unsigned long mask = 1ul << node;
+  const unsigned flags = move ? MPOL_MF_MOVE : 0;
+  return ::syscall(SYS_mbind, (void*)lo, (unsigned long)(hi - lo), MPOL_BIND,
+                   &mask, (unsigned long)(sizeof(mask) * 8), flags) == 0;
+}
+
+int current_node() {
+  unsigned cpu = 0, node = 0;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return -1;
+  return (int)node;
+}
+
+int pages_node(const void* const* addrs, size_t count) {
+  constexpr size_t kMax = 64;
+  count = std::min(count, kMax);
+  if (count == 0) return -1;
+  const uintptr_t page = (uintptr_t)::sysconf(_SC_PAGESIZE);
+  void* pages[kMax];
+  int status[kMax];
+  for (size_t i = 0; i < count; ++i) pages[i] = (void*)((uintptr_t)addrs[i] & ~(page - 1));
+  // nodes == nullptr：只查询，status[i] 为节点号或负的 errno（如未分配的 -ENOENT）
+  if (::syscall(SYS_move_pages, 0, (unsigned long)count, pages, nullptr, status, 0) != 0) return -1;
+  int votes[64] = {0};
+  int best = -1;
+  for (size_t i = 0; i < count; ++i) {
+    const int nd = status[i];
+    if (nd < 0 || nd >= 64) continue;
+    ++votes[nd];
+    if (best < 0 || votes[nd] > votes[best]) best = nd;
+  }
+  return best;
+}
+
+int region_node(const void* p, size_t len) {
+  if (!p || len == 0) return -1;
+  constexpr size_t kSample = 32;
+  const void* addrs[kSample];
+  const size_t cnt = std::min(kSample, len);
+  for (size_t i = 0; i < cnt; ++i)
+    addrs[i] = static_cast<const char*>(p) + len * i / cnt;
+  return pages_node(addrs, cnt);
+}
+
+NodeBuffer::~NodeBuffer() { release(); }
+
+NodeBuffer::NodeBuffer(NodeBuffer&& o) noexcept { *this = std::move(o); }
+
+NodeBuffer& NodeBuffer::operator=(NodeBuffer&& o) noexcept {
+  if (this != &o) {
+    release();
+    base_ = o.base_; len_ = o.len_; node_ = o.node_; bound_ = o.bound_;
+    o.base_ = nullptr; o.len_ = 0; o.node_ = -1; o.bound_ = false;
+  }
+  return *this;
+}
+
+void NodeBuffer::release() {
+  if (base_) ::munmap(base_, len_);
+  base_ = nullptr; len_ = 0; node_ = -1; bound_ = false;
+}
+
+bool NodeBuffer::ensure(size_t bytes, int node, Pages pages) {
+  if (base_ && len_ >= bytes && node_ == node) return true;
+  release();
+  if (bytes == 0) bytes = 1;
+
+  constexpr size_t kHuge = 2u << 20;
+  void* p = MAP_FAILED;
+  size_t len = bytes;
+  if (pages == Pages::HugeTLB) {
+    len = (bytes + kHuge - 1) / kHuge * kHuge;
+    p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+  if (p == MAP_FAILED) {   // 普通页，或 hugetlb 池为空时回退
+    len = (pages == Pages::THP) ? (bytes + kHuge - 1) / kHuge * kHuge : bytes;
+    p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    if (pages == Pages::THP) ::madvise(p, len, MADV_HUGEPAGE);
+  }
+  base_ = p; len_ = len; node_ = node;
+  bound_ = bind(base_, len_, node, false);   // 尚未触碰：之后的缺页都在目标节点上分配
+  return true;
+}
+
+} // namespace numa
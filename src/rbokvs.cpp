@@ -1,9 +1,10 @@
 #include "rbokvs.hpp"
 #include <algorithm>
-#include <unordered_map>
 #include <cstdint>
 #include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <type_traits>
 
 void benchmark_okvs(const std::vector<KV>& kvs, const OKVSParams& p) {
     using namespace std::chrono;
@@ -19,20 +20,26 @@ void benchmark_okvs(const std::vector<KV>& kvs, const OKVSParams& p) {
 }
 
 
-// ============ 小工具：GF(2^128) 加法 = 128bit XOR ============
+// okvs_bench.csv 逐次记录：默认关闭，OTPSI_OKVS_LOG=1 开启。
+// 每次调用都要打开文件追加一行，多线程 / 多进程的 S13、S14 会被串行化在文件 I/O 上，
+// 开启后各阶段耗时与 DAG 关键路径不再可信，只用于单独测 OKVS 本身
+static bool okvs_log_enabled() {
+    static const bool on = [] {
+        const char* e = std::getenv("OTPSI_OKVS_LOG");
+        return e && std::atoi(e) != 0;
+    }();
+    return on;
+}
+
+// ============ 小工具：GF(2^k) 加法 = XOR ============
 static inline void xor_inplace(Block128& a, const Block128& b) {
     a.hi ^= b.hi; a.lo ^= b.lo;
 }
+static inline void xor_inplace(u64& a, const u64& b) { a ^= b; }
 static inline bool is_zero128(const Block128& x) {
     return (x.hi | x.lo) == 0ull;
 }
-
-// ============ 极小概率“全 0 带”兜底 ============
-static inline void ensure_nonzero(std::vector<uint8_t>& u) {
-    bool all0 = true;
-    for (auto b : u) { if (b) { all0 = false; break; } }
-    if (all0 && !u.empty()) u[0] = 1;
-}
+static inline bool is_zero128(const u64& x) { return x == 0ull; }
 
 // ============ 简单可复现 PRG：splitmix64 ============
 static inline uint64_t splitmix64(uint64_t& x) {
@@ -48,117 +55,113 @@ static inline Block128 prg_block(uint64_t k1, uint64_t k2) {
     b.lo = splitmix64(s);
     return b;
 }
+template <class V>
+static inline V prg_value(uint64_t k1, uint64_t k2) {
+    if constexpr (std::is_same_v<V, Block128>) return prg_block(k1, k2);
+    else return prg_block(k1, k2).hi;
+}
 
-// ============ 行结构 ============
-struct RowBand {
-    size_t a;
-    std::vector<uint8_t> u;
-    Block128 v;
-
-    size_t first_one() const {
-        for (size_t j = 0; j < u.size(); ++j) if (u[j]) return j;
-        return u.size();
-    }
-    void xor_with(const RowBand& other) {
-        const size_t W = u.size();
-        for (size_t j = 0; j < W; ++j) u[j] ^= other.u[j];
-        xor_inplace(v, other.v);
-    }
-};
+// ============ 行运算 ============
+static inline size_t first_one(const uint8_t* u, size_t w) {
+    for (size_t j = 0; j < w; ++j) if (u[j]) return j;
+    return w;
+}
 
 // ============ 编码 ============
-RBOKVS RBOKVS::Encode(const std::vector<KV>& kvs, const OKVSParams& p) {
+template <class V>
+RBOKVST<V> RBOKVST<V>::Encode(const std::vector<KVT<V>>& kvs, const OKVSParams& p) {
+    RBOKVST out;
+    Scratch sc;
+    EncodeInto(out, kvs, p, sc);
+    return out;
+}
+
+template <class V>
+void RBOKVST<V>::EncodeInto(RBOKVST& out, const std::vector<KVT<V>>& kvs, const OKVSParams& p, Scratch& sc) {
     using clk = std::chrono::high_resolution_clock;
-    auto t0 = clk::now();
+    const bool log = okvs_log_enabled();
+    const auto t0 = log ? clk::now() : clk::time_point{};
+    constexpr size_t kNone = SIZE_MAX;
 
-    RBOKVS out; out.p = p;
+    out.p = p;
     const size_t m = p.m;
     const uint32_t w = p.w;
 
     if (m == 0 || w == 0 || m <= w) {
-        out.S.assign(std::max<size_t>(1, m ? m : 1), Block128{0,0});
+        out.S.assign(std::max<size_t>(1, m ? m : 1), V{});
         for (size_t i = 0; i < out.S.size(); ++i)
-            out.S[i] = prg_block(p.seed_r1 ^ (uint64_t)i, p.seed_r2 + (uint64_t)m);
-        return out;
+            out.S[i] = prg_value<V>(p.seed_r1 ^ (uint64_t)i, p.seed_r2 + (uint64_t)m);
+        return;
     }
 
-    // 1) 构造行
-    std::vector<RowBand> rows; rows.reserve(kvs.size());
-    for (const auto& e : kvs) {
-        RowBand r;
-        r.a = H1(e.key, p);
-        r.u = H2(e.key, p);
-        ensure_nonzero(r.u);
-        r.v = e.val;
-        rows.emplace_back(std::move(r));
+    // 1) 构造行：各行位图连续放在 sc.bits，行本身不含堆内存
+    auto& rows = sc.rows;
+    const size_t N = kvs.size();
+    sc.bits.resize(N * w);
+    rows.resize(N);
+    for (size_t r = 0; r < N; ++r) {
+        Row& row = rows[r];
+        row.a = H1(kvs[r].key, p);
+        row.u = sc.bits.data() + r * w;
+        H2(kvs[r].key, p, row.u);
+        const size_t j = first_one(row.u, w);
+        row.lead = (j < w) ? (row.a + j) : kNone;
+        row.v = kvs[r].val;
     }
 
     // 2) 排序
-    auto lead_col = [&](const RowBand& r)->size_t {
-        size_t j = r.first_one();
-        return (j < r.u.size()) ? (r.a + j) : (size_t)-1;
-    };
-    std::sort(rows.begin(), rows.end(), [&](const RowBand& x, const RowBand& y){
-        return lead_col(x) < lead_col(y);
-    });
-
-    // 3) 消元
-    std::vector<RowBand> basis; basis.reserve(rows.size());
-    std::unordered_map<size_t, size_t> pivot_at;
-    pivot_at.reserve(rows.size() * 2);
-
-    for (auto& r : rows) {
+    std::sort(rows.begin(), rows.end(), [](const Row& x, const Row& y){ return x.lead < y.lead; });
+
+    // 3) 消元：主元行留在 rows 原位，pivot_at 记其下标
+    auto& pivot_at = sc.pivot_at;
+    pivot_at.assign(m, kNone);
+    for (size_t ri = 0; ri < N; ++ri) {
+        Row& r = rows[ri];
         for (size_t off = 0; off < w; ++off) {
             if (!r.u[off]) continue;
-            const size_t col = r.a + off;
-            auto it = pivot_at.find(col);
-            if (it != pivot_at.end()) {
-                r.xor_with(basis[it->second]);
+            const size_t piv = pivot_at[r.a + off];
+            if (piv != kNone) {
+                const Row& b = rows[piv];
+                for (size_t j = 0; j < w; ++j) r.u[j] ^= b.u[j];
+                xor_inplace(r.v, b.v);
             }
         }
-        size_t j = r.first_one();
+        size_t j = first_one(r.u, w);
         if (j == w) {
             if (!is_zero128(r.v)) {
-                out.S.assign(m, Block128{0,0});
+                out.S.assign(m, V{});
                 for (size_t i = 0; i < m; ++i)
-                    out.S[i] = prg_block(p.seed_r1 + (uint64_t)i, p.seed_r2 ^ 0xA5A5A5A5A5A5A5A5ull);
-                return out;
+                    out.S[i] = prg_value<V>(p.seed_r1 + (uint64_t)i, p.seed_r2 ^ 0xA5A5A5A5A5A5A5A5ull);
+                return;
             }
             continue;
         }
-        const size_t col = r.a + j;
-        pivot_at[col] = basis.size();
-        basis.emplace_back(std::move(r));
+        pivot_at[r.a + j] = ri;
     }
 
     // 4) 自由列随机化
-    out.S.assign(m, Block128{0,0});
-    std::vector<uint8_t> is_free(m, 1);
-    for (auto& pr : pivot_at) is_free[pr.first] = 0;
+    out.S.assign(m, V{});
     for (size_t col = 0; col < m; ++col) {
-        if (is_free[col]) {
-            out.S[col] = prg_block(p.seed_r1 ^ (uint64_t)(0x1111111111111111ull + col),
+        if (pivot_at[col] == kNone) {
+            out.S[col] = prg_value<V>(p.seed_r1 ^ (uint64_t)(0x1111111111111111ull + col),
                                    p.seed_r2 ^ (uint64_t)(0x2222222222222222ull + col));
         }
     }
 
-    // 5) 回代
-    std::vector<size_t> piv_cols; piv_cols.reserve(pivot_at.size());
-    for (auto& pr : pivot_at) piv_cols.push_back(pr.first);
-    std::sort(piv_cols.begin(), piv_cols.end(), std::greater<size_t>());
-
-    for (size_t pc : piv_cols) {
-        const RowBand& r = basis[pivot_at[pc]];
-        size_t jstar = r.first_one();
-        Block128 acc = r.v;
+    // 5) 回代：主元列从大到小
+    for (size_t pc = m; pc-- > 0; ) {
+        if (pivot_at[pc] == kNone) continue;
+        const Row& r = rows[pivot_at[pc]];
+        const size_t jstar = pc - r.a;
+        V acc = r.v;
         for (size_t j = 0; j < w; ++j) {
             if (!r.u[j] || j == jstar) continue;
-            const size_t col = r.a + j;
-            xor_inplace(acc, out.S[col]);
+            xor_inplace(acc, out.S[r.a + j]);
         }
         out.S[pc] = acc;
     }
 
+    if (!log) return;
     auto t1 = clk::now();
     double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
 
@@ -167,22 +170,21 @@ RBOKVS RBOKVS::Encode(const std::vector<KV>& kvs, const OKVSParams& p) {
     ofs << "encode," << kvs.size() << "," << m << "," << (double)kvs.size()/m
         << "," << ms << "\n";
     ofs.close();
-
-    return out;
 }
 
 // ============ 解码 ============
-Block128 RBOKVS::Decode(const Block128& key) const {
+template <class V>
+V RBOKVST<V>::DecodeAt(const OKVSParams& p, const V* S, const Block128& key) {
     using clk = std::chrono::high_resolution_clock;
-    auto t0 = clk::now();
+    const bool log = okvs_log_enabled();
+    const auto t0 = log ? clk::now() : clk::time_point{};
 
     const size_t a = H1(key, p);
-    auto u = H2(key, p);
-    ensure_nonzero(u);
-    Block128 acc{0,0};
-    for (uint32_t j = 0; j < p.w; ++j) {
-        if (u[j]) xor_inplace(acc, S[a + j]);
-    }
+    V acc{};
+    // 位全 0 时按 H2 的兜底取第 0 位
+    if (!H2_for_each_bit(key, p, [&](size_t j){ xor_inplace(acc, S[a + j]); }) && p.w > 0)
+        xor_inplace(acc, S[a]);
+    if (!log) return acc;
 
     auto t1 = clk::now();
     double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
@@ -195,3 +197,6 @@ Block128 RBOKVS::Decode(const Block128& key) const {
     return acc;
 }
 
+// 显式实例化：GF(2^128) 与 GF(2^64) 两种值宽度
+template struct RBOKVST<Block128>;
+template struct RBOKVST<u64>;
@@ -0,0 +1,245 @@
+#include "run_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+// ============ 产物大小（用于 LRU 记账） ============
+template <class V, class T>
+size_t EncodedPartiesT<V, T>::byte_size() const {
+  size_t b = 0;
+  for (const auto& v : kv_all)  b += v.size() * sizeof(KVT<V>);
+  for (const auto& v : tag_all) b += v.size() * sizeof(T);
+  for (const auto& o : okvs)    b += o.byte_size();
+  return b;
+}
+
+// ============ 缓存键 ============
+static inline void upd_u64(blake3_hasher& h, uint64_t x) {
+  uint8_t b[8];
+  for (int i = 0; i < 8; ++i) b[i] = (uint8_t)(x >> (8 * i));
+  blake3_hasher_update(&h, b, 8);
+}
+
+RunDigest run_digest(const std::vector<std::vector<Block128>>& Xs,
+                     const std::vector<OKVSParams>& params,
+                     int k, u64 poly_salt, u64 salt_tag, int field_bits, int tag_bits) {
+  blake3_hasher h;
+  blake3_hasher_init_derive_key(&h, "OTPSI run cache v2 S12/S13");
+  upd_u64(h, (uint64_t)field_bits);
+  upd_u64(h, (uint64_t)tag_bits);
+  upd_u64(h, (uint64_t)k);
+  upd_u64(h, poly_salt);
+  upd_u64(h, salt_tag);
+  upd_u64(h, (uint64_t)Xs.size());
+  for (size_t i = 1; i < Xs.size(); ++i) {
+    const OKVSParams& p = params[i];
+    upd_u64(h, p.m); upd_u64(h, p.w); upd_u64(h, p.seed_r1); upd_u64(h, p.seed_r2);
+    upd_u64(h, Xs[i].size());
+    uint8_t in[16];
+    for (const auto& x : Xs[i]) {
+      ser_block128_be(x, in);
+      blake3_hasher_update(&h, in, 16);
+    }
+  }
+  RunDigest d;
+  blake3_hasher_finalize(&h, d.data(), d.size());
+  return d;
+}
+
+std::string digest_hex(const RunDigest& d) {
+  static const char* hexd = "0123456789abcdef";
+  std::string s; s.reserve(64);
+  for (uint8_t b : d) { s.push_back(hexd[b >> 4]); s.push_back(hexd[b & 15]); }
+  return s;
+}
+
+// ============ 内存层（LRU） ============
+template <class V, class T>
+RunCacheT<V, T>::RunCacheT(size_t max_bytes, std::string disk_dir)
+  : max_bytes_(max_bytes), disk_dir_(std::move(disk_dir)) {}
+
+template <class V, class T>
+std::string RunCacheT<V, T>::path_of(const RunDigest& key) const {
+  return disk_dir_ + "/" + digest_hex(key) + ".okvsc";
+}
+
+template <class V, class T>
+std::shared_ptr<const EncodedPartiesT<V, T>> RunCacheT<V, T>::get(const RunDigest& key,
+                                                                  const std::vector<size_t>& sizes) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      ++st_.hits;
+      return it->second->val;
+    }
+  }
+  if (!disk_dir_.empty()) {
+    std::shared_ptr<const EncodedParties> e = load_encoded<V, T>(path_of(key), key, sizes);
+    std::lock_guard<std::mutex> lk(mu_);
+    if (e) {
+      ++st_.disk_hits;
+      insert_locked(key, e);
+      return e;
+    }
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  ++st_.misses;
+  return nullptr;
+}
+
+template <class V, class T>
+void RunCacheT<V, T>::put(const RunDigest& key, std::shared_ptr<const EncodedParties> val) {
+  if (!val) return;
+  if (!disk_dir_.empty()) save_encoded(path_of(key), key, *val);
+  std::lock_guard<std::mutex> lk(mu_);
+  insert_locked(key, std::move(val));
+}
+
+template <class V, class T>
+void RunCacheT<V, T>::insert_locked(const RunDigest& key, std::shared_ptr<const EncodedParties> val) {
+  const size_t bytes = val->byte_size();
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    st_.bytes -= it->second->bytes;
+    lru_.erase(it->second);
+    index_.erase(it);
+  }
+  if (bytes > max_bytes_) return;   // 单条超过上限：只走磁盘层
+  while (!lru_.empty() && st_.bytes + bytes > max_bytes_) {
+    st_.bytes -= lru_.back().bytes;
+    index_.erase(lru_.back().key);
+    lru_.pop_back();
+    ++st_.evictions;
+  }
+  lru_.push_front(Entry{key, std::move(val), bytes});
+  index_[key] = lru_.begin();
+  st_.bytes += bytes;
+}
+
+template <class V, class T>
+typename RunCacheT<V, T>::Stats RunCacheT<V, T>::stats() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return st_;
+}
+
+// ============ 磁盘层 ============
+// 布局：magic(8) | digest(32) | sizeof(V) | sizeof(T) | n | 正文 | BLAKE3(正文)(32)
+// 正文 = 每方 { |kv| kv[] | |tag| tag[] | m w r1 r2 | |S| S[] }
+static const char kMagic[8] = {'O','T','P','S','I','E','C','4'};
+
+static void wr_raw(std::ofstream& o, blake3_hasher& h, const void* p, size_t len) {
+  o.write(static_cast<const char*>(p), (std::streamsize)len);
+  blake3_hasher_update(&h, p, len);
+}
+
+template <class E>
+static void wr_vec(std::ofstream& o, blake3_hasher& h, const std::vector<E>& v) {
+  uint64_t sz = v.size();
+  wr_raw(o, h, &sz, sizeof(sz));
+  wr_raw(o, h, v.data(), sz * sizeof(E));
+}
+
+// left 为正文剩余字节：长度字段超出剩余部分说明文件损坏，先拒绝再 resize（避免 bad_alloc）
+static bool rd_raw(std::ifstream& in, blake3_hasher& h, void* p, size_t len, uint64_t& left) {
+  if (left < len || !in.read(static_cast<char*>(p), (std::streamsize)len)) return false;
+  left -= len;
+  blake3_hasher_update(&h, p, len);
+  return true;
+}
+
+template <class E>
+static bool rd_vec(std::ifstream& in, blake3_hasher& h, std::vector<E>& v, uint64_t& left) {
+  uint64_t sz = 0;
+  if (!rd_raw(in, h, &sz, sizeof(sz), left)) return false;
+  if (sz > left / sizeof(E)) return false;
+  v.resize(sz);
+  return rd_raw(in, h, v.data(), sz * sizeof(E), left);
+}
+
+template <class V, class T>
+bool save_encoded(const std::string& path, const RunDigest& key, const EncodedPartiesT<V, T>& e) {
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream o(tmp, std::ios::binary | std::ios::trunc);
+    if (!o) return false;
+    o.write(kMagic, sizeof(kMagic));
+    o.write(reinterpret_cast<const char*>(key.data()), key.size());
+    uint64_t widths[2] = { sizeof(V), sizeof(T) };
+    o.write(reinterpret_cast<const char*>(widths), sizeof(widths));
+    uint64_t n = e.okvs.size();
+    o.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    blake3_hasher h;
+    blake3_hasher_init(&h);
+    for (size_t i = 0; i < n; ++i) {
+      wr_vec(o, h, e.kv_all[i]);
+      wr_vec(o, h, e.tag_all[i]);
+      const OKVSParams& p = e.okvs[i].p;
+      uint64_t hdr[4] = { p.m, p.w, p.seed_r1, p.seed_r2 };
+      wr_raw(o, h, hdr, sizeof(hdr));
+      wr_vec(o, h, e.okvs[i].S);
+    }
+    RunDigest sum;
+    blake3_hasher_finalize(&h, sum.data(), sum.size());
+    o.write(reinterpret_cast<const char*>(sum.data()), sum.size());
+    if (!o) return false;
+  }
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+template <class V, class T>
+std::shared_ptr<EncodedPartiesT<V, T>> load_encoded(const std::string& path, const RunDigest& key,
+                                                    const std::vector<size_t>& sizes) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) return nullptr;
+  const std::streamoff fsize = in.tellg();
+  if (fsize < 0 || !in.seekg(0)) return nullptr;
+  char magic[8]; RunDigest got;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) return nullptr;
+  if (!in.read(reinterpret_cast<char*>(got.data()), got.size()) || got != key) return nullptr;
+  uint64_t widths[2] = {0, 0};
+  if (!in.read(reinterpret_cast<char*>(widths), sizeof(widths))) return nullptr;
+  if (widths[0] != sizeof(V) || widths[1] != sizeof(T)) return nullptr;
+  uint64_t n = 0;
+  if (!in.read(reinterpret_cast<char*>(&n), sizeof(n))) return nullptr;
+  if (n != sizes.size()) return nullptr;
+  const uint64_t head = (uint64_t)in.tellg();
+  if ((uint64_t)fsize < head + sizeof(RunDigest)) return nullptr;
+  uint64_t left = (uint64_t)fsize - head - sizeof(RunDigest);
+
+  blake3_hasher h;
+  blake3_hasher_init(&h);
+  auto e = std::make_shared<EncodedPartiesT<V, T>>();
+  e->kv_all.resize(n); e->tag_all.resize(n); e->okvs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    // 份额与标签必须与本次输入的 |X_i| 一一对应：S14 按 |X_i| 分配 σ 暂存并按下标读标签
+    if (!rd_vec(in, h, e->kv_all[i], left) || e->kv_all[i].size() != sizes[i]) return nullptr;
+    if (!rd_vec(in, h, e->tag_all[i], left) || e->tag_all[i].size() != sizes[i]) return nullptr;
+    uint64_t hdr[4];
+    if (!rd_raw(in, h, hdr, sizeof(hdr), left)) return nullptr;
+    OKVSParams& p = e->okvs[i].p;
+    p.m = hdr[0]; p.w = hdr[1]; p.seed_r1 = hdr[2]; p.seed_r2 = hdr[3];
+    if (!rd_vec(in, h, e->okvs[i].S, left)) return nullptr;
+    // 与 Encode 的输出长度一致（下标 0 的空位为 m=0、S 为空）
+    const size_t s_len = e->okvs[i].S.size();
+    if (!(s_len == 0 && p.m == 0) && s_len != std::max<uint64_t>(1, p.m)) return nullptr;
+  }
+  if (left != 0) return nullptr;
+  RunDigest sum, want;
+  blake3_hasher_finalize(&h, want.data(), want.size());
+  if (!in.read(reinterpret_cast<char*>(sum.data()), sum.size()) || sum != want) return nullptr;
+  return e;
+}
+
+// 显式实例化：GF(2^128) / GF(2^64) × 32 / 64 / 128 bit 标签
+#define OTPSI_INSTANTIATE_CACHE(V, T) \
+  template struct EncodedPartiesT<V, T>; \
+  template class RunCacheT<V, T>;
+OTPSI_INSTANTIATE_CACHE(Block128, u32)
+OTPSI_INSTANTIATE_CACHE(Block128, u64)
+OTPSI_INSTANTIATE_CACHE(Block128, Tag128)
+OTPSI_INSTANTIATE_CACHE(u64, u32)
+OTPSI_INSTANTIATE_CACHE(u64, u64)
+OTPSI_INSTANTIATE_CACHE(u64, Tag128)
+#undef OTPSI_INSTANTIATE_CACHE
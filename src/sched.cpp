@@ -0,0 +1,161 @@
+#include "sched.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace sched {
+
+// ============ 线程池 ============
+Pool::Pool(unsigned threads) : Pool(threads, nullptr) {}
+
+Pool::Pool(unsigned threads, std::function<void(unsigned)> on_start) : on_start_(std::move(on_start)) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads_.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) threads_.emplace_back([this, t]{ worker(t); });
+}
+
+Pool::~Pool() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& th : threads_) th.join();
+}
+
+void Pool::post(std::coroutine_handle<> h) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    q_.push_back(h);
+  }
+  cv_.notify_one();
+}
+
+void Pool::worker(unsigned t) {
+  if (on_start_) on_start_(t);
+  for (;;) {
+    std::coroutine_handle<> h;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [&]{ return stop_ || !q_.empty(); });
+      if (q_.empty()) return;   // stop_ 且已排空
+      h = q_.front(); q_.pop_front();
+    }
+    h.resume();
+  }
+}
+
+// ============ 事件 ============
+void Event::set() {
+  std::vector<std::coroutine_handle<>> ws;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    set_ = true;
+    ws.swap(waiters_);
+  }
+  // 等待者恢复后会立刻 co_await 下一个依赖或 pool.schedule()，这里只是轻量推进
+  for (auto h : ws) h.resume();
+}
+
+void Event::reset() {
+  std::lock_guard<std::mutex> lk(mu_);
+  set_ = false;
+}
+
+// ============ DAG ============
+Graph::~Graph() { quiesce(); }
+
+void Graph::quiesce() {
+  for (Node& nd : nodes_)
+    while (nd.live.load(std::memory_order_acquire)) std::this_thread::yield();
+}
+
+void Graph::clear() {
+  quiesce();
+  nodes_.clear();
+}
+
+Graph::NodeId Graph::add(std::string name, std::vector<NodeId> deps, std::function<void()> fn, int hint) {
+  Node& nd = nodes_.emplace_back();
+  nd.name = std::move(name);
+  nd.deps = std::move(deps);
+  nd.fn   = std::move(fn);
+  nd.hint = hint;
+  return nodes_.size() - 1;
+}
+
+void* Graph::Task::promise_type::operator new(size_t sz, Graph&, Node& nd, Pool&, Completion&,
+                                              std::chrono::steady_clock::time_point) {
+  if (nd.frame_cap < kHdr + sz) {
+    nd.frame.reset(new std::byte[kHdr + sz]);
+    nd.frame_cap = kHdr + sz;
+  }
+  *reinterpret_cast<Node**>(nd.frame.get()) = &nd;
+  nd.live.store(true, std::memory_order_relaxed);
+  return nd.frame.get() + kHdr;
+}
+
+void Graph::Task::promise_type::operator delete(void* p, size_t) noexcept {
+  Node* nd = *reinterpret_cast<Node**>(static_cast<std::byte*>(p) - kHdr);
+  nd->live.store(false, std::memory_order_release);
+}
+
+Graph::Task Graph::drive(Graph& g, Node& nd, Pool& pool, Completion& c,
+                         std::chrono::steady_clock::time_point epoch) {
+  using ms = std::chrono::duration<double, std::milli>;
+  for (NodeId d : nd.deps) co_await g.nodes_[d].done;
+  co_await pool.schedule();
+
+  nd.t0_ms = ms(std::chrono::steady_clock::now() - epoch).count();
+  nd.fn();
+  nd.t1_ms = ms(std::chrono::steady_clock::now() - epoch).count();
+
+  nd.done.set();
+  // 计数与通知都在锁内完成：run() 返回（c 析构）前本协程已不再访问 c
+  std::lock_guard<std::mutex> lk(c.mu);
+  if (--c.left == 0) c.cv.notify_all();
+}
+
+Graph::Report Graph::run(const std::vector<Pool*>& pools) {
+  using ms = std::chrono::duration<double, std::milli>;
+  Report rep;
+  if (nodes_.empty() || pools.empty()) return rep;
+
+  // 上一轮的协程在通知完成后才销毁帧：等它们全部退出再复用帧与事件
+  quiesce();
+  for (Node& nd : nodes_) nd.done.reset();
+
+  Completion c;
+  c.left = nodes_.size();
+  auto epoch = std::chrono::steady_clock::now();
+  for (size_t v = 0; v < nodes_.size(); ++v) {
+    Node& nd = nodes_[v];
+    const size_t which = nd.hint >= 0 ? (size_t)nd.hint : v;
+    drive(*this, nd, *pools[which % pools.size()], c, epoch);
+  }
+  {
+    std::unique_lock<std::mutex> lk(c.mu);
+    c.cv.wait(lk, [&]{ return c.left == 0; });
+  }
+  rep.wall_ms = ms(std::chrono::steady_clock::now() - epoch).count();
+
+  // 关键路径：cp[v] = dur[v] + max_{d∈deps(v)} cp[d]（加入顺序即拓扑序）
+  const size_t N = nodes_.size();
+  std::vector<double> cp(N, 0.0);
+  std::vector<size_t> prev(N, (size_t)-1);
+  size_t tail = 0;
+  for (size_t v = 0; v < N; ++v) {
+    double best = 0.0;
+    for (NodeId d : nodes_[v].deps) {
+      if (cp[d] > best || prev[v] == (size_t)-1) { best = cp[d]; prev[v] = d; }
+    }
+    cp[v] = best + node_ms(v);
+    rep.work_ms += node_ms(v);
+    if (cp[v] > cp[tail]) tail = v;
+  }
+  rep.critical_ms = cp[tail];
+  for (size_t v = tail; v != (size_t)-1; v = prev[v]) rep.critical_path.push_back(nodes_[v].name);
+  std::reverse(rep.critical_path.begin(), rep.critical_path.end());
+  return rep;
+}
+
+} // namespace sched
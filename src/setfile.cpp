@@ -0,0 +1,126 @@
+#include "setfile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kSetMagic[8] = {'O','T','P','S','I','S','E','T'};
+static constexpr uint64_t kDataAlign = 64;
+
+std::string set_file_path(const std::string& dir, int party_id) {
+  return dir + "/party_" + std::to_string(party_id) + ".oset";
+}
+
+// ============ 写 ============
+bool write_set_file(const std::string& path, uint64_t party_id, const std::vector<Block128>& xs) {
+  SetFileHeader h{};
+  std::memcpy(h.magic, kSetMagic, sizeof(kSetMagic));
+  h.version     = 1;
+  h.elem_bytes  = sizeof(Block128);
+  h.count       = xs.size();
+  h.party_id    = party_id;
+  h.data_offset = (sizeof(SetFileHeader) + kDataAlign - 1) / kDataAlign * kDataAlign;
+
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream o(tmp, std::ios::binary | std::ios::trunc);
+    if (!o) return false;
+    o.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    static const char pad[kDataAlign] = {};
+    o.write(pad, (std::streamsize)(h.data_offset - sizeof(h)));
+    o.write(reinterpret_cast<const char*>(xs.data()), (std::streamsize)(xs.size() * sizeof(Block128)));
+    if (!o) return false;
+  }
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// ============ 映射 ============
+MappedSet::MappedSet(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SetFileHeader)) { ::close(fd); return; }
+
+  void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return;
+  base_ = p; len_ = (size_t)st.st_size;
+
+  const auto* h = static_cast<const SetFileHeader*>(p);
+  const bool valid =
+      std::memcmp(h->magic, kSetMagic, sizeof(kSetMagic)) == 0 &&
+      h->version == 1 && h->elem_bytes == sizeof(Block128) &&
+      h->data_offset % kDataAlign == 0 && h->data_offset >= sizeof(SetFileHeader) &&
+      h->data_offset <= len_ && h->count <= (len_ - h->data_offset) / sizeof(Block128);
+  if (!valid) { ::munmap(base_, len_); base_ = nullptr; len_ = 0; return; }
+
+  count_    = h->count;
+  party_id_ = h->party_id;
+  if (count_) {
+    data_ = reinterpret_cast<const Block128*>(static_cast<const char*>(p) + h->data_offset);
+    ::madvise(base_, len_, MADV_SEQUENTIAL);   // madvise 需页对齐：作用于整个映射
+    ::madvise(base_, len_, MADV_WILLNEED);
+  }
+}
+
+MappedSet::~MappedSet() {
+  if (base_) ::munmap(base_, len_);
+}
+
+MappedSet::MappedSet(MappedSet&& o) noexcept { *this = std::move(o); }
+
+MappedSet& MappedSet::operator=(MappedSet&& o) noexcept {
+  if (this != &o) {
+    if (base_) ::munmap(base_, len_);
+    base_ = o.base_; len_ = o.len_; data_ = o.data_; count_ = o.count_; party_id_ = o.party_id_;
+    o.base_ = nullptr; o.len_ = 0; o.data_ = nullptr; o.count_ = 0;
+  }
+  return *this;
+}
+
+// ============ 并行加载 ============
+std::vector<std::vector<Block128>> load_set_dir(const std::string& dir, unsigned threads) {
+  std::vector<MappedSet> maps(1);
+  for (int i = 1; ; ++i) {
+    const std::string path = set_file_path(dir, i);
+    if (::access(path.c_str(), R_OK) != 0) break;
+    MappedSet ms(path);
+    if (!ms.ok() || ms.party_id() != (uint64_t)i) return {};
+    maps.push_back(std::move(ms));
+  }
+  const size_t n = maps.size() - 1;
+  if (n == 0) return {};
+
+  std::vector<std::vector<Block128>> Xs(n + 1);
+  // 切成固定大小的块，线程按原子计数领取：大集合与小集合都能均匀分摊
+  constexpr size_t kChunk = 1 << 16;
+  struct Piece { size_t party, lo, hi; };
+  std::vector<Piece> pieces;
+  for (size_t i = 1; i <= n; ++i) {
+    Xs[i].resize(maps[i].size());
+    for (size_t lo = 0; lo < maps[i].size(); lo += kChunk)
+      pieces.push_back({i, lo, std::min(maps[i].size(), lo + kChunk)});
+  }
+
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(1, pieces.size()));
+  std::atomic<size_t> next{0};
+  auto worker = [&]{
+    for (size_t p; (p = next.fetch_add(1)) < pieces.size(); ) {
+      const Piece& pc = pieces[p];
+      std::memcpy(Xs[pc.party].data() + pc.lo, maps[pc.party].data() + pc.lo,
+                  (pc.hi - pc.lo) * sizeof(Block128));
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+  worker();
+  for (auto& th : pool) th.join();
+  return Xs;
+}
@@ -0,0 +1,70 @@
+#include "shm.hpp"
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace shm {
+
+uint64_t now_ns() {
+  timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// ============ 共享区 ============
+Region::Region(const char* name, size_t bytes) {
+  if (bytes == 0) bytes = 1;
+  int fd = ::memfd_create(name, MFD_CLOEXEC);
+  if (fd < 0) return;
+  if (::ftruncate(fd, (off_t)bytes) != 0) { ::close(fd); return; }
+  void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);   // 映射持有引用，fd 可立即关闭
+  if (p == MAP_FAILED) return;
+  base_ = p; len_ = bytes;
+}
+
+Region::~Region() {
+  if (base_) ::munmap(base_, len_);
+}
+
+Region::Region(Region&& o) noexcept { *this = std::move(o); }
+
+Region& Region::operator=(Region&& o) noexcept {
+  if (this != &o) {
+    if (base_) ::munmap(base_, len_);
+    base_ = o.base_; len_ = o.len_;
+    o.base_ = nullptr; o.len_ = 0;
+  }
+  return *this;
+}
+
+// ============ 门铃 ============
+// 跨进程共享，不能用 FUTEX_PRIVATE_FLAG
+static long futex(std::atomic<uint32_t>* addr, int op, uint32_t val, const timespec* to) {
+  return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), op, val, to, nullptr, 0);
+}
+
+void ring(Doorbell& d) {
+  d.seq.fetch_add(1, std::memory_order_seq_cst);
+  if (d.waiting.load(std::memory_order_seq_cst)) futex(&d.seq, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+void wait(Doorbell& d, uint32_t seen, int timeout_ms) {
+  d.waiting.store(1, std::memory_order_seq_cst);
+  if (d.seq.load(std::memory_order_seq_cst) == seen) {
+    timespec to{ timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+    futex(&d.seq, FUTEX_WAIT, seen, &to);   // seq 已变则立即返回 EAGAIN
+  }
+  d.waiting.store(0, std::memory_order_relaxed);
+}
+
+// ============ 环 ============
+size_t Ring::capacity_for(size_t max_payload, size_t max_msgs) {
+  // 占用区内至多一条回绕填充，新消息可能再带一条：各按一条整消息预留
+  return (max_msgs + 2) * align8(sizeof(MsgHdr) + max_payload);
+}
+
+} // namespace shm